@@ -0,0 +1,109 @@
+/*example2-FifoWatermark*/
+#include <Wire.h>
+#include <QMA6100P.h>
+#include <QMA6100P_batch.h>
+
+#define USB_TX_PIN PA12 // D- pin
+#define USB_RX_PIN PA11 // D+ pin
+#define I2C_SDA_PIN PB11
+#define I2C_SCL_PIN PB10
+#define ACCEL_INT1 PB5
+#define ACCEL_INT2 PB6
+#define DB_LED_PIN PA15
+
+// Frames per wake-up. One batch is drained in a single I2C transaction
+// only if it fits the Wire buffer: 5 frames with the usual 32 bytes. A
+// bigger batch (up to 64) wakes the MCU less often but takes one
+// transaction per 5 frames.
+#define BATCH_SIZE (SFE_ACCEL_I2C_BUFFER_LENGTH / 6)
+
+QMA6100P qmaAccel;
+QMA6100P_Batch batch(qmaAccel);
+
+rawOutputData samples[BATCH_SIZE];
+outputData myData;
+
+#include <SoftwareSerial.h>
+
+SoftwareSerial softSerial(USB_RX_PIN, USB_TX_PIN);
+
+void accelISR()
+{
+  batch.handleInterrupt();
+}
+
+void setup()
+{
+  softSerial.begin(38400);
+  delay(2000);
+  softSerial.println("serial start");
+
+  pinMode(DB_LED_PIN, OUTPUT);
+  pinMode(ACCEL_INT1, INPUT);
+
+  // Configure I2C
+  Wire.setSDA(I2C_SDA_PIN);
+  Wire.setSCL(I2C_SCL_PIN);
+  Wire.begin();
+
+  if (!qmaAccel.begin())
+  {
+    softSerial.println("ERROR: Could not communicate with the the QMA6100P. Freezing.");
+    while (1)
+      ;
+  }
+
+  if (!qmaAccel.softwareReset())
+    softSerial.println("ERROR: Failed to reset");
+
+  delay(5);
+
+  if(!qmaAccel.setRange(SFE_QMA6100P_RANGE8G)){
+    softSerial.println("ERROR: failed to set range");
+  }
+
+  // 100 Hz, so a 5 frame batch (32 byte Wire buffer) wakes the MCU about
+  // 20 times a second
+  if(!qmaAccel.setOutputDataRate(SFE_QMA6100P_MCLK_51_2K, SFE_QMA6100P_DIV_512)){
+    softSerial.println("ERROR: failed to set output data rate");
+  }
+
+  if(!qmaAccel.enableAccel()){
+    softSerial.println("ERROR: failed to set active mode");
+  }
+
+  if(!batch.begin(BATCH_SIZE, 1, ACCEL_INT1)){
+    softSerial.println("ERROR: failed to set up the FIFO watermark");
+  }
+
+  attachInterrupt(digitalPinToInterrupt(ACCEL_INT1), accelISR, RISING);
+
+  softSerial.print("Expected wake-ups/s: ");
+  softSerial.println(batch.getExpectedWakeRate(), 2);
+  softSerial.println("Ready.");
+}
+
+void loop()
+{
+  int count = batch.service(samples);
+
+  if (count > 0)
+  {
+    // Process the batch, here just print the newest sample
+    qmaAccel.convAccelData(&myData, &samples[count - 1]);
+    softSerial.print("X: ");
+    softSerial.print(myData.xData, 2);
+    softSerial.print(" Y: ");
+    softSerial.print(myData.yData, 2);
+    softSerial.print(" Z: ");
+    softSerial.print(myData.zData, 2);
+    softSerial.print(" wake-ups/s: ");
+    softSerial.print(batch.getWakeRate(), 2);
+    softSerial.println();
+  }
+
+  if (!batch.pending())
+  {
+    // Put the MCU to sleep here; the watermark interrupt wakes it
+  }
+}
@@ -0,0 +1,103 @@
+// Mock TwoWire for host tests. It models a QMA6100P well enough for the
+// FIFO paths: a register file, a FIFO level register that always reports
+// 20 frames and a FIFO data port whose x axis is a running 13 bit counter,
+// so a consumer can check that no sample was lost or duplicated.
+//
+// Every transaction is checked against overlap: two tasks inside the bus at
+// once means the bus lock failed, and is counted in collisions.
+
+#pragma once
+
+#include "Arduino.h"
+#include <atomic>
+#include <vector>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire
+{
+public:
+  void begin() {}
+  void end() {}
+  void setClock(uint32_t) {}
+
+  void beginTransmission(uint8_t)
+  {
+    enter();
+    _tx.clear();
+  }
+
+  size_t write(uint8_t data)
+  {
+    _tx.push_back(data);
+    return 1;
+  }
+
+  uint8_t endTransmission(bool = true)
+  {
+    if (!_tx.empty())
+      _reg = _tx[0];
+    for (size_t i = 1; i < _tx.size(); i++)
+      regs[(uint8_t)(_reg + i - 1)] = _tx[i];
+
+    leave();
+    return 0;
+  }
+
+  uint8_t requestFrom(int, int len, int = 1)
+  {
+    enter();
+
+    _rx.clear();
+    _pos = 0;
+
+    for (int i = 0; i < len && i < BUFFER_LENGTH; i++)
+    {
+      if (_reg == 0x0e) // FIFO_ST
+        _rx.push_back(20);
+      else if (_reg == 0x3f) // FIFO_DATA, LSB first with the NEWDATA bit
+        _rx.push_back(fifoByte(i));
+      else
+        _rx.push_back(regs[(uint8_t)(_reg + i)]);
+    }
+
+    leave();
+    return (uint8_t)_rx.size();
+  }
+
+  int available() { return (int)(_rx.size() - _pos); }
+  int read() { return _pos < _rx.size() ? _rx[_pos++] : -1; }
+
+  uint8_t regs[256] = {0};
+  std::atomic<int> collisions{0};
+
+protected:
+  uint8_t fifoByte(int i)
+  {
+    int axis = (i / 2) % 3;
+    if (axis == 0 && i % 2 == 0)
+      _word = (uint16_t)((_counter++ & 0x1fff) << 2) | 1;
+    else if (i % 2 == 0)
+      _word = 1;
+
+    return i % 2 == 0 ? (uint8_t)(_word & 0xff) : (uint8_t)(_word >> 8);
+  }
+
+  void enter()
+  {
+    if (_inUse.fetch_add(1) != 0)
+      collisions++;
+  }
+
+  void leave() { _inUse.fetch_sub(1); }
+
+  std::atomic<int> _inUse{0};
+  uint8_t _reg = 0;
+  std::vector<uint8_t> _tx;
+  std::vector<uint8_t> _rx;
+  size_t _pos = 0;
+  uint16_t _word = 0;
+  uint16_t _counter = 0;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,302 @@
+#include "KX134.h"
+
+bool KX134::begin(uint8_t address, TwoWire &wirePort)
+{
+  _address = address;
+  setPort(wirePort);
+
+  if (getUniqueID() != KX134_WHO_AM_I)
+    return false;
+
+  return true;
+}
+
+uint8_t KX134::getUniqueID()
+{
+  uint8_t tempVal;
+  if(!readRegisterRegion(SFE_KX134_WHO_AM_I, &tempVal, 1))
+    return 0xFF;
+
+  return tempVal;
+}
+
+//////////////////////////////////////////////////
+// softwareReset()
+//
+// Writes 0x00 to 0x7F, then sets SRST in CNTL2. The part needs
+// about 2ms before it answers on the bus again; CNTL2 is then polled
+// until SRST has cleared.
+//
+// Returns false if the part does not come back within about 12ms.
+//
+bool KX134::softwareReset()
+{
+  // Defaults are coming back on purpose, nothing to re-apply
+  clearShadow();
+
+  if(!writeRegisterByte(SFE_KX134_RESET_PREP, 0x00))
+    return false;
+
+  sfe_kx134_cntl2_bitfield_t cntl2;
+  cntl2.all = 0;
+  cntl2.bits.srst = 1;
+
+  // The part resets mid transaction and may not acknowledge this write,
+  // so it is sent once without the retries
+  {
+    SFE_AccelBusGuard guard(_busLock);
+    transferWrite(SFE_KX134_CNTL2, cntl2.all);
+  }
+
+  delay(2);
+
+  cacheRange(-1);
+
+  // Single attempts: a NACK here means the part is still rebooting
+  for (int i = 0; i < 10; i++)
+  {
+    int received;
+    {
+      SFE_AccelBusGuard guard(_busLock);
+      received = transferRead(SFE_KX134_CNTL2, &cntl2.all, 1);
+    }
+
+    if (received == 1 && cntl2.bits.srst == 0)
+      return true;
+
+    delay(1);
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////
+// enableAccel()
+//
+// Switches between stand-by and operating mode. Range, data rate
+// and buffer settings can only be changed in stand-by.
+//
+// Parameter:
+// enable - enables or disables the accelerometer
+//
+bool KX134::enableAccel(bool enable)
+{
+  uint8_t tempVal;
+
+  if(!readRegisterRegion(SFE_KX134_CNTL1, &tempVal, 1))
+    return false;
+
+  sfe_kx134_cntl1_bitfield_t cntl1;
+  cntl1.all = tempVal;
+  cntl1.bits.pc1 = enable;
+  tempVal = cntl1.all;
+
+  if(!writeRegisterByte(SFE_KX134_CNTL1, tempVal))
+    return false;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// getOperatingMode()
+//
+// Retrieves the current operating mode - stand-by/operating mode
+//
+uint8_t KX134::getOperatingMode()
+{
+  uint8_t tempVal;
+
+  if(!readRegisterRegion(SFE_KX134_CNTL1, &tempVal, 1))
+    return false;
+
+  sfe_kx134_cntl1_bitfield_t cntl1;
+  cntl1.all = tempVal;
+
+  return (cntl1.bits.pc1);
+}
+
+//////////////////////////////////////////////////
+// setRange()
+//
+// Sets the operational g-range of the accelerometer.
+//
+// Parameter:
+// range - SFE_KX134_RANGE8G to SFE_KX134_RANGE64G
+//
+bool KX134::setRange(uint8_t range)
+{
+  uint8_t tempVal;
+
+  if (range > SFE_KX134_RANGE64G)
+    return false;
+
+  if(!readRegisterRegion(SFE_KX134_CNTL1, &tempVal, 1))
+    return false;
+
+  sfe_kx134_cntl1_bitfield_t cntl1;
+  cntl1.all = tempVal;
+  cntl1.bits.gsel = range;
+  tempVal = cntl1.all;
+
+  if(!writeRegisterByte(SFE_KX134_CNTL1, tempVal))
+    return false;
+
+  cacheRange(range); // Update our local copy
+
+  return true;
+}
+
+// return current setting for acceleration range
+uint8_t KX134::getRange()
+{
+  int range;
+
+  if(!readRangeSetting(&range))
+    return 0xFF;
+
+  return range;
+}
+
+//////////////////////////////////////////////////
+// setOutputDataRate()
+//
+// Parameter:
+// rate - OSA code, 0 (0.781 Hz) to 15 (25600 Hz)
+//
+bool KX134::setOutputDataRate(uint8_t rate)
+{
+  uint8_t tempVal;
+
+  if (rate > 15)
+    return false;
+
+  if(!readRegisterRegion(SFE_KX134_ODCNTL, &tempVal, 1))
+    return false;
+
+  sfe_kx134_odcntl_bitfield_t odcntl;
+  odcntl.all = tempVal;
+  odcntl.bits.osa = rate;
+  tempVal = odcntl.all;
+
+  if(!writeRegisterByte(SFE_KX134_ODCNTL, tempVal))
+    return false;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// enableBuffer()
+//
+// Enables the sample buffer with 16 bit samples so getFifoData()
+// can drain it.
+//
+// Parameter:
+// enable - enables or disables the buffer
+// mode - SFE_KX134_BUFFER_MODE_xxx
+//
+bool KX134::enableBuffer(bool enable, uint8_t mode)
+{
+  uint8_t tempVal;
+
+  if (mode > SFE_KX134_BUFFER_MODE_TRIGGER)
+    return false;
+
+  if(!readRegisterRegion(SFE_KX134_BUF_CNTL2, &tempVal, 1))
+    return false;
+
+  sfe_kx134_buf_cntl2_bitfield_t buf_cntl2;
+  buf_cntl2.all = tempVal;
+  buf_cntl2.bits.bufe = enable;
+  buf_cntl2.bits.bres = 1;
+  buf_cntl2.bits.bm = mode;
+  tempVal = buf_cntl2.all;
+
+  if(!writeRegisterByte(SFE_KX134_BUF_CNTL2, tempVal))
+    return false;
+
+  return true;
+}
+
+// discards everything in the sample buffer
+bool KX134::clearBuffer()
+{
+  return writeRegisterByte(SFE_KX134_BUF_CLEAR, 0x00);
+}
+
+//***************************************** SFE_AccelCore backend ******************************************
+
+
+// X/Y/Z are plain 16 bit two's complement, there are no new data flags
+bool KX134::readAccelRegisters(rawOutputData *rawAccelData)
+{
+  uint8_t tempRegData[6] = {0};
+
+  if(!readRegisterRegion(SFE_KX134_XOUT_L, tempRegData, 6)) // Read 3 * 16-bit
+    return false;
+
+  decodeFifoFrame(tempRegData, rawAccelData);
+
+  return true;
+}
+
+// reads the g-range code from CNTL1
+bool KX134::readRangeSetting(int *range)
+{
+  uint8_t regVal;
+
+  if(!readRegisterRegion(SFE_KX134_CNTL1, &regVal, 1))
+    return false;
+
+  sfe_kx134_cntl1_bitfield_t cntl1;
+  cntl1.all = regVal;
+
+  *range = cntl1.bits.gsel;
+
+  return true;
+}
+
+// g per count for a range code, 0 if the code is not a valid range
+float KX134::getConversion(int range)
+{
+  switch (range)
+  {
+  case SFE_KX134_RANGE8G:
+    return convRange8G;
+  case SFE_KX134_RANGE16G:
+    return convRange16G;
+  case SFE_KX134_RANGE32G:
+    return convRange32G;
+  case SFE_KX134_RANGE64G:
+    return convRange64G;
+  default:
+    return 0;
+  }
+}
+
+// the buffer level registers count bytes, a 16 bit frame is 6 of them
+bool KX134::readFifoLevel(uint16_t *frames)
+{
+  uint8_t tempRegData[2];
+
+  if(!readRegisterRegion(SFE_KX134_BUF_STATUS_1, tempRegData, 2))
+    return false;
+
+  uint16_t bytes = ((uint16_t)(tempRegData[1] & 0x03) << 8) | tempRegData[0];
+
+  *frames = bytes / 6;
+
+  return true;
+}
+
+void KX134::decodeFifoFrame(const uint8_t *frame, rawOutputData *sample)
+{
+  sample->xData = (int16_t)(((uint16_t)(frame[1] << 8)) | frame[0]);
+  sample->yData = (int16_t)(((uint16_t)(frame[3] << 8)) | frame[2]);
+  sample->zData = (int16_t)(((uint16_t)(frame[5] << 8)) | frame[4]);
+}
+
+// registers whose writes are commands rather than settings
+bool KX134::isConfigRegister(uint8_t reg)
+{
+  return reg != SFE_KX134_CNTL2 && reg != SFE_KX134_BUF_CLEAR && reg != SFE_KX134_RESET_PREP;
+}
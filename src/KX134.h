@@ -0,0 +1,64 @@
+// The following class implements the methods to set, get, and read from the
+// Triple Axis Accelerometer - KX134. Register access, conversion, offsets and
+// FIFO draining are shared with the QMA6100P through SFE_AccelCore.
+
+#pragma once
+
+#include "SFE_AccelCore.h"
+#include "KX134_regs.h"
+
+#define KX134_ADDRESS_HIGH 0x1F
+#define KX134_ADDRESS_LOW 0x1E
+
+#define KX134_WHO_AM_I 0x46
+
+// CNTL1 GSEL<1:0>
+#define SFE_KX134_RANGE8G 0b00
+#define SFE_KX134_RANGE16G 0b01
+#define SFE_KX134_RANGE32G 0b10
+#define SFE_KX134_RANGE64G 0b11
+
+// BUF_CNTL2 BM<1:0>
+#define SFE_KX134_BUFFER_MODE_FIFO    0b00
+#define SFE_KX134_BUFFER_MODE_STREAM  0b01
+#define SFE_KX134_BUFFER_MODE_TRIGGER 0b10
+
+class KX134 : public SFE_AccelCore<KX134>
+{
+  friend class SFE_AccelCore<KX134>;
+
+public:
+  KX134() : SFE_AccelCore<KX134>(KX134_ADDRESS_HIGH) {}
+
+  bool begin(uint8_t address = KX134_ADDRESS_HIGH, TwoWire &wirePort = Wire);
+  uint8_t getUniqueID();
+
+  // General Settings
+  bool enableAccel(bool enable = true);
+  bool softwareReset();
+  uint8_t getOperatingMode();
+  bool setRange(uint8_t);
+  uint8_t getRange();
+  bool setOutputDataRate(uint8_t rate);
+  bool enableBuffer(bool enable = true, uint8_t mode = SFE_KX134_BUFFER_MODE_STREAM);
+  bool clearBuffer();
+
+  // KX134 conversion values
+  const double convRange8G = .000244;
+  const double convRange16G = .000488;
+  const double convRange32G = .000977;
+  const double convRange64G = .001953;
+
+protected:
+  // SFE_AccelCore backend
+  bool readAccelRegisters(rawOutputData *rawAccelData);
+  bool readRangeSetting(int *range);
+  float getConversion(int range);
+  bool readFifoLevel(uint16_t *frames);
+  uint8_t fifoDataRegister() { return SFE_KX134_BUF_READ; }
+  uint8_t fifoFrameBytes() { return 6; }
+  void decodeFifoFrame(const uint8_t *frame, rawOutputData *sample);
+  bool isConfigRegister(uint8_t reg);
+  bool isDestructiveRead(uint8_t reg) { return reg == SFE_KX134_BUF_READ; }
+  uint8_t sentinelRegister() { return SFE_KX134_CNTL1; } // PC1 clear after power-on
+};
@@ -0,0 +1,123 @@
+//  KX134_regs.h
+//
+// This file holds the bit fields for the KX134 registers used by the
+// shared accelerometer core.
+
+#pragma once
+
+#define SFE_KX134_MAN_ID 0x00 // Returns "KION" in ASCII
+
+#define SFE_KX134_XOUT_L 0x08
+/*
+XOUT, YOUT, ZOUT: 16 bit two's complement output, low byte first,
+starting at XOUT_L and ending at ZOUT_H (0x0D).
+*/
+#define SFE_KX134_XOUT_H 0x09
+#define SFE_KX134_YOUT_L 0x0A
+#define SFE_KX134_YOUT_H 0x0B
+#define SFE_KX134_ZOUT_L 0x0C
+#define SFE_KX134_ZOUT_H 0x0D
+
+#define SFE_KX134_WHO_AM_I 0x13
+
+#define SFE_KX134_INS2 0x17
+
+#define SFE_KX134_INT_REL 0x1A
+
+#define SFE_KX134_CNTL1 0x1B
+/*
+PC1: 1, high performance / low power operating mode
+     0, stand-by mode, settings may be changed
+RES: 1, high performance mode
+     0, low power mode
+DRDYE: 1, data ready engine enabled
+GSEL<1:0>: 00 8g, 01 16g, 10 32g, 11 64g
+TDTE: tap/double tap engine enable
+TPE: tilt position engine enable
+*/
+typedef struct
+{
+  uint8_t tpe : 1;
+  uint8_t blank : 1;
+  uint8_t tdte : 1;
+  uint8_t gsel : 2;
+  uint8_t drdye : 1;
+  uint8_t res : 1;
+  uint8_t pc1 : 1;
+} sfe_kx134_cntl1_t;
+
+typedef union
+{
+  uint8_t all;
+  sfe_kx134_cntl1_t bits;
+} sfe_kx134_cntl1_bitfield_t;
+
+#define SFE_KX134_CNTL2 0x1C
+/*
+SRST: 1, start the RAM reboot / software reset
+*/
+typedef struct
+{
+  uint8_t blank : 7;
+  uint8_t srst : 1;
+} sfe_kx134_cntl2_t;
+
+typedef union
+{
+  uint8_t all;
+  sfe_kx134_cntl2_t bits;
+} sfe_kx134_cntl2_bitfield_t;
+
+#define SFE_KX134_ODCNTL 0x21
+/*
+LPRO: 1, low-pass filter corner at ODR/2
+      0, low-pass filter corner at ODR/9
+FSTUP: 1, fast start-up enabled
+OSA<3:0>: output data rate, 0.781 Hz (0) to 25600 Hz (15), 50 Hz (6) default
+*/
+typedef struct
+{
+  uint8_t osa : 4;
+  uint8_t blank : 1;
+  uint8_t fstup : 1;
+  uint8_t lpro : 1;
+  uint8_t blank2 : 1;
+} sfe_kx134_odcntl_t;
+
+typedef union
+{
+  uint8_t all;
+  sfe_kx134_odcntl_t bits;
+} sfe_kx134_odcntl_bitfield_t;
+
+#define SFE_KX134_BUF_CNTL1 0x5E // SMP_TH<7:0>, sample buffer watermark
+
+#define SFE_KX134_BUF_CNTL2 0x5F
+/*
+BUFE: 1, sample buffer active
+BRES: 1, 16 bit samples
+      0, 8 bit samples
+BFIE: 1, buffer full interrupt enabled
+BM<1:0>: 00 FIFO, 01 stream, 10 trigger
+*/
+typedef struct
+{
+  uint8_t bm : 2;
+  uint8_t blank : 3;
+  uint8_t bfie : 1;
+  uint8_t bres : 1;
+  uint8_t bufe : 1;
+} sfe_kx134_buf_cntl2_t;
+
+typedef union
+{
+  uint8_t all;
+  sfe_kx134_buf_cntl2_t bits;
+} sfe_kx134_buf_cntl2_bitfield_t;
+
+#define SFE_KX134_BUF_STATUS_1 0x60 // SMP_LEV<7:0>, bytes in the buffer
+#define SFE_KX134_BUF_STATUS_2 0x61 // SMP_LEV<9:8> in bits 1:0, BUF_TRIG in bit 7
+#define SFE_KX134_BUF_CLEAR 0x62    // any write clears the buffer
+#define SFE_KX134_BUF_READ 0x63     // buffer read port
+
+#define SFE_KX134_RESET_PREP 0x7F   // must be written 0x00 before a software reset
@@ -17,6 +17,10 @@ uint8_t QMA6100P::getUniqueID()
 //
 bool QMA6100P::softwareReset()
 {
+  // Defaults are coming back on purpose, nothing to re-apply
+  clearShadow();
+  cacheRange(-1);
+
   if(!writeRegisterByte(SFE_QMA6100P_SR, static_cast<uint8_t>(0xb6)))
     return false;
 
@@ -116,7 +120,7 @@ bool QMA6100P::setRange(uint8_t range)
   if(!writeRegisterByte(SFE_QMA6100P_FSR, tempVal))
     return false;
 
-  _range = range; // Update our local copy
+  cacheRange(range); // Update our local copy
 
   return true;
 }
@@ -149,7 +153,7 @@ bool QMA6100P::enableDataEngine(bool enable)
 {
   uint8_t tempVal;
 
-  if(!readRegisterRegion(SFE_QMA6100P_PM, &tempVal, 1))
+  if(!readRegisterRegion(SFE_QMA6100P_INT_MAP1, &tempVal, 1))
     return false;
 
   sfe_qma6100p_int_map1_bitfield_t int_map1;
@@ -196,212 +200,498 @@ bool QMA6100P::setFifoMode(uint8_t fifo_mode){
 }
 
 //////////////////////////////////////////////////
-// getRawAccelRegisterData()
+// setFifoWatermark()
 //
-// Retrieves the raw register values representing accelerometer data.
+// Sets the FIFO level that raises the watermark interrupt. Writing
+// the watermark clears the FIFO.
+//
+// Parameter:
+// frames - watermark level, 1 to 64 XYZ frames
+//
+bool QMA6100P::setFifoWatermark(uint8_t frames)
+{
+  if (frames == 0 || frames > 64)
+    return false;
+
+  if(!writeRegisterByte(SFE_QMA6100P_FIFO_WM, frames))
+    return false;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// enableFifoInterrupt()
 //
+// Enables the FIFO watermark and/or full interrupts and routes
+// them to an INT pin.
 //
 // Parameter:
-// *rawAccelData - a pointer to the data struct that holds acceleromter X/Y/Z data.
+// watermark - enables the watermark interrupt
+// full - enables the FIFO full interrupt
+// pin - 1 for INT1, 2 for INT2
 //
-bool QMA6100P::getRawAccelRegisterData(rawOutputData *rawAccelData)
+bool QMA6100P::enableFifoInterrupt(bool watermark, bool full, uint8_t pin)
 {
-  uint8_t tempRegData[6] = {0};
-  int16_t tempData = 0;
+  uint8_t tempVal;
 
-  if(!readRegisterRegion(SFE_QMA6100P_DX_L, tempRegData, 6)) // Read 3 * 16-bit
+  if (pin != 1 && pin != 2)
     return false;
 
-  // check newData_X
-  if(tempRegData[0] & 0x1){
-    tempData = (int16_t)(((uint16_t)(tempRegData[1] << 8)) | (tempRegData[0]));
-    rawAccelData->xData = tempData >> 2;
+  if (pin == 1)
+  {
+    if(!readRegisterRegion(SFE_QMA6100P_INT_MAP1, &tempVal, 1))
+      return false;
+
+    sfe_qma6100p_int_map1_bitfield_t int_map1;
+    int_map1.all = tempVal;
+    int_map1.bits.int1_fwm = watermark;
+    int_map1.bits.int1_ffull = full;
+    tempVal = int_map1.all;
+
+    if(!writeRegisterByte(SFE_QMA6100P_INT_MAP1, tempVal))
+      return false;
   }
-  // check newData_Y
-  if(tempRegData[2] & 0x1){
-    tempData = (int16_t)(((uint16_t)(tempRegData[3] << 8)) | (tempRegData[2]));
-    rawAccelData->yData = tempData >> 2;
-  } 
-  // check newData_Z
-  if(tempRegData[4] & 0x1){
-    tempData = (int16_t)(((uint16_t)(tempRegData[5] << 8)) | (tempRegData[4]));
-    rawAccelData->zData = tempData >> 2;
+  else
+  {
+    if(!readRegisterRegion(SFE_QMA6100P_INT_MAP3, &tempVal, 1))
+      return false;
+
+    sfe_qma6100p_int_map3_bitfield_t int_map3;
+    int_map3.all = tempVal;
+    int_map3.bits.int2_fwm = watermark;
+    int_map3.bits.int2_ffull = full;
+    tempVal = int_map3.all;
+
+    if(!writeRegisterByte(SFE_QMA6100P_INT_MAP3, tempVal))
+      return false;
   }
 
+  if(!readRegisterRegion(SFE_QMA6100P_INT_EN1, &tempVal, 1))
+    return false;
+
+  sfe_qma6100p_int_en1_bitfield_t int_en1;
+  int_en1.all = tempVal;
+  int_en1.bits.int_fwm_en = watermark;
+  int_en1.bits.int_ffull_en = full;
+  tempVal = int_en1.all;
+
+  if(!writeRegisterByte(SFE_QMA6100P_INT_EN1, tempVal))
+    return false;
+
   return true;
 }
 
-//////////////////////////////////////////////////////////////////////////////////
-// readRegisterRegion()
+//////////////////////////////////////////////////
+// getFifoStatus()
+//
+// Reads the FIFO interrupt flags from INT_ST2.
+//
+// Parameter:
+// *watermark - set when the watermark level has been reached
+// *full - set when the FIFO is full
+// *overrun - set when old frames have been discarded
+//
+bool QMA6100P::getFifoStatus(bool *watermark, bool *full, bool *overrun)
+{
+  uint8_t tempVal;
+
+  if(!readRegisterRegion(SFE_QMA6100P_INT_ST2, &tempVal, 1))
+    return false;
+
+  sfe_qma6100p_int_st2_bitfield_t int_st2;
+  int_st2.all = tempVal;
+
+  *watermark = int_st2.bits.fifo_wm_int;
+  *full = int_st2.bits.fifo_full_int;
+  *overrun = int_st2.bits.fifo_or;
 
-bool QMA6100P::readRegisterRegion(uint8_t registerAddress, uint8_t* sensorData, int len)
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setBandwidth()
+//
+// Sets the output data rate divider. The output data rate is
+// MCLK / divider, so the same divider gives a different rate
+// for every master clock selected with setClock().
+//
+// Parameter:
+// divider - SFE_QMA6100P_DIV_32 to SFE_QMA6100P_DIV_4096
+//
+bool QMA6100P::setBandwidth(uint8_t divider)
 {
-  Wire.beginTransmission(QMA6100P_ADDRESS_HIGH);
-  Wire.write(registerAddress); // Register address to read from
-  uint8_t err = Wire.endTransmission(); // Send the request without stopping the transmission
+  uint8_t tempVal;
 
-  if (err > 0) {
+  if (divider > SFE_QMA6100P_DIV_4096)
     return false;
-  }
 
-  uint8_t bytesAvailable = Wire.requestFrom(static_cast<int>(QMA6100P_ADDRESS_HIGH), static_cast<int>(len), static_cast<int>(true)); // Request len byte of data
+  if(!readRegisterRegion(SFE_QMA6100P_BW, &tempVal, 1))
+    return false;
 
-  delay(10);
+  sfe_qma6100p_bw_bitfield_t bw;
+  bw.all = tempVal;
+  bw.bits.bw = divider; // low pass filter bits are left untouched
+  tempVal = bw.all;
 
-  if (bytesAvailable >= len) {
-    for (uint8_t i = 0; i < len; i++) {
-      sensorData[i] = Wire.read(); // Read the bytes from the sensor and store them in the array pointed to by sensorData
-    }
-    return true; // Return true if the read operation was successful
-  } else {
+  if(!writeRegisterByte(SFE_QMA6100P_BW, tempVal))
     return false;
-  }
+
+  return true;
 }
 
+// return current output data rate divider
+uint8_t QMA6100P::getBandwidth()
+{
+  uint8_t tempVal;
+
+  if(!readRegisterRegion(SFE_QMA6100P_BW, &tempVal, 1))
+    return 0xFF;
+
+  sfe_qma6100p_bw_bitfield_t bw;
+  bw.all = tempVal;
 
-//////////////////////////////////////////////////////////////////////////////////
-// writeRegisterRegion()
+  return bw.bits.bw;
+}
 
-bool QMA6100P::writeRegisterByte(uint8_t registerAddress, uint8_t data)
+//////////////////////////////////////////////////
+// setClock()
+//
+// Sets the master clock. A slower clock lowers the supply current
+// and, for a fixed divider, the output data rate.
+//
+// Parameter:
+// mclk - SFE_QMA6100P_MCLK_102_4K to SFE_QMA6100P_MCLK_6_4K
+//
+bool QMA6100P::setClock(uint8_t mclk)
 {
-  Wire.beginTransmission(QMA6100P_ADDRESS_HIGH);
-  Wire.write(registerAddress); // Register address to write to
-  Wire.write(data); // Data to write, dereferenced from the pointer
-  uint8_t err = Wire.endTransmission(); // End the transmission
+  uint8_t tempVal;
 
-  if (err > 0) {
-    return false; // Return false if there's a communication error
-  }
+  if (mclk < SFE_QMA6100P_MCLK_102_4K || mclk > SFE_QMA6100P_MCLK_6_4K)
+    return false;
 
-  return true; // Return true if the write operation was successful
+  if(!readRegisterRegion(SFE_QMA6100P_PM, &tempVal, 1))
+    return false;
+
+  sfe_qma6100p_pm_bitfield_t pm;
+  pm.all = tempVal;
+  pm.bits.mclk_sel = mclk;
+  tempVal = pm.all;
+
+  if(!writeRegisterByte(SFE_QMA6100P_PM, tempVal))
+    return false;
+
+  return true;
 }
 
+// return current master clock selection
+uint8_t QMA6100P::getClock()
+{
+  uint8_t tempVal;
+
+  if(!readRegisterRegion(SFE_QMA6100P_PM, &tempVal, 1))
+    return 0xFF;
 
-//***************************************** QMA6100P ******************************************************
+  sfe_qma6100p_pm_bitfield_t pm;
+  pm.all = tempVal;
 
+  return pm.bits.mclk_sel;
+}
 
-bool QMA6100P::begin()
+//////////////////////////////////////////////////
+// setOutputDataRate()
+//
+// Changes master clock and divider together. The part is put in
+// standby for the change so the CIC filter restarts cleanly, then
+// returned to the operating mode it was in.
+//
+// Parameter:
+// mclk - master clock, SFE_QMA6100P_MCLK_xxx
+// divider - output data rate divider, SFE_QMA6100P_DIV_xxx
+//
+bool QMA6100P::setOutputDataRate(uint8_t mclk, uint8_t divider)
 {
-  if (getUniqueID() != QMA6100P_CHIP_ID)
+  uint8_t tempVal;
+
+  if (mclk < SFE_QMA6100P_MCLK_102_4K || mclk > SFE_QMA6100P_MCLK_6_4K)
+    return false;
+
+  if (divider > SFE_QMA6100P_DIV_4096)
+    return false;
+
+  if(!readRegisterRegion(SFE_QMA6100P_PM, &tempVal, 1))
+    return false;
+
+  sfe_qma6100p_pm_bitfield_t pm;
+  pm.all = tempVal;
+  bool active = pm.bits.mode_bit;
+
+  pm.bits.mode_bit = 0; // standby while the clock changes
+  pm.bits.mclk_sel = mclk;
+
+  if(!writeRegisterByte(SFE_QMA6100P_PM, pm.all))
     return false;
 
+  if(!setBandwidth(divider))
+    return false;
+
+  if (active)
+  {
+    pm.bits.mode_bit = 1;
+    if(!writeRegisterByte(SFE_QMA6100P_PM, pm.all))
+      return false;
+  }
+
   return true;
 }
 
-bool QMA6100P::calibrateOffsets()
+//////////////////////////////////////////////////
+// getSamplePeriod()
+//
+// Returns the nominal time between samples in microseconds
+// for a master clock / divider pair, or 0 if either is invalid.
+//
+uint32_t QMA6100P::getSamplePeriod(uint8_t mclk, uint8_t divider)
 {
-    outputData data;
-    int numSamples = 100;
-    float xSum = 0.0, ySum = 0.0, zSum = 0.0;
-
-
-    // Take multiple samples to average out noise
-    for (int i = 0; i < numSamples; i++)
-    {
-        if (!getAccelData(&data))
-            return false;
-        
-        xSum += data.xData;
-        ySum += data.yData;
-        zSum += data.zData - 1;
-        delay(10);
-    }
-
-    // Calculate average
-    xOffset = xSum / numSamples;
-    yOffset = ySum / numSamples;
-    zOffset = zSum / numSamples;  // Assuming z-axis aligned with gravity
-
-    return true;
+  static const uint16_t dividers[] = {512, 256, 128, 64, 32, 1024, 2048, 4096};
+
+  if (mclk < SFE_QMA6100P_MCLK_102_4K || mclk > SFE_QMA6100P_MCLK_6_4K)
+    return 0;
+
+  if (divider > SFE_QMA6100P_DIV_4096)
+    return 0;
+
+  // MCLK_102_4K is 102400 Hz, every step down halves it
+  uint32_t mclkHz = 102400UL >> (mclk - SFE_QMA6100P_MCLK_102_4K);
+
+  return (1000000UL * dividers[divider] + mclkHz / 2) / mclkHz;
 }
 
-//////////////////////////////////////////////////////////////////////////////////
-// getAccelData()
+//////////////////////////////////////////////////
+// enableMotionDetect()
 //
-// Retrieves the raw accelerometer data and calls a conversion function to convert the raw values.
+// Enables the any-motion engine on all three axes. The result can
+// be polled with getMotionStatus() or routed to an INT pin.
 //
 // Parameter:
-// *userData - a pointer to the user's data struct that will hold acceleromter data.
+// threshold - slope threshold in units of 16 LSB
+// duration - number of samples above threshold minus one (0 - 3)
+// enable - enables or disables any-motion detection
+// pin - 1 for INT1, 2 for INT2, 0 to leave the pin mapping alone
 //
-bool QMA6100P::getAccelData(outputData *userData)
+bool QMA6100P::enableMotionDetect(uint8_t threshold, uint8_t duration, bool enable, uint8_t pin)
 {
+  uint8_t tempVal;
+
+  if (duration > 3 || pin > 2)
+    return false;
+
+  if (pin == 1)
+  {
+    if(!readRegisterRegion(SFE_QMA6100P_INT_MAP1, &tempVal, 1))
+      return false;
+
+    sfe_qma6100p_int_map1_bitfield_t int_map1;
+    int_map1.all = tempVal;
+    int_map1.bits.int1_any_mot = enable;
+    tempVal = int_map1.all;
+
+    if(!writeRegisterByte(SFE_QMA6100P_INT_MAP1, tempVal))
+      return false;
+  }
+  else if (pin == 2)
+  {
+    if(!readRegisterRegion(SFE_QMA6100P_INT_MAP3, &tempVal, 1))
+      return false;
+
+    sfe_qma6100p_int_map3_bitfield_t int_map3;
+    int_map3.all = tempVal;
+    int_map3.bits.int2_any_mot = enable;
+    tempVal = int_map3.all;
+
+    if(!writeRegisterByte(SFE_QMA6100P_INT_MAP3, tempVal))
+      return false;
+  }
+
+  if (enable)
+  {
+    if(!writeRegisterByte(SFE_QMA6100P_MOT_CONF2, threshold))
+      return false;
+
+    if(!readRegisterRegion(SFE_QMA6100P_MOT_CONF0, &tempVal, 1))
+      return false;
+
+    sfe_qma6100p_mot_conf0_bitfield_t mot_conf0;
+    mot_conf0.all = tempVal;
+    mot_conf0.bits.any_mot_dur = duration;
+    tempVal = mot_conf0.all;
 
-  if(!getRawAccelRegisterData(&rawAccelData))
+    if(!writeRegisterByte(SFE_QMA6100P_MOT_CONF0, tempVal))
+      return false;
+  }
+
+  if(!readRegisterRegion(SFE_QMA6100P_INT_EN2, &tempVal, 1))
     return false;
 
-  if(!convAccelData(userData, &rawAccelData))
+  sfe_qma6100p_int_en2_bitfield_t int_en2;
+  int_en2.all = tempVal;
+  int_en2.bits.any_mot_en_x = enable;
+  int_en2.bits.any_mot_en_y = enable;
+  int_en2.bits.any_mot_en_z = enable;
+  tempVal = int_en2.all;
+
+  if(!writeRegisterByte(SFE_QMA6100P_INT_EN2, tempVal))
     return false;
 
   return true;
 }
 
-//////////////////////////////////////////////////////////////////////////////////
-// convAccelData()
+//////////////////////////////////////////////////
+// getMotionStatus()
 //
-// Converts raw acceleromter data with the current accelerometer's range settings.
+// Reports whether the any-motion engine has fired on any axis.
+//
+// Parameter:
+// *motion - set to true when motion was detected
+//
+bool QMA6100P::getMotionStatus(bool *motion)
+{
+  uint8_t tempVal;
+
+  if(!readRegisterRegion(SFE_QMA6100P_INT_ST0, &tempVal, 1))
+    return false;
+
+  sfe_qma6100p_int_st0_bitfield_t int_st0;
+  int_st0.all = tempVal;
+
+  *motion = int_st0.bits.any_mot_first_x || int_st0.bits.any_mot_first_y || int_st0.bits.any_mot_first_z;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// getNewDataFlags()
+//
+// Returns which axes the last getAccelData() / getRawAccelRegisterData()
+// updated: bit 0 x, bit 1 y, bit 2 z. An axis without NEWDATA keeps
+// its previous value. Shared by all tasks reading this sensor.
+//
+uint8_t QMA6100P::getNewDataFlags()
+{
+  SFE_AccelBusGuard guard(_busLock);
+  return _newData;
+}
+
+//***************************************** QMA6100P ******************************************************
+
+
+bool QMA6100P::begin(uint8_t address, TwoWire &wirePort)
+{
+  _address = address;
+  setPort(wirePort);
+
+  if (getUniqueID() != QMA6100P_CHIP_ID)
+    return false;
+
+  return true;
+}
+
+//***************************************** SFE_AccelCore backend ******************************************
+
+
+//////////////////////////////////////////////////
+// readAccelRegisters()
+//
+// Retrieves the raw register values representing accelerometer data.
+// An axis is only updated when its NEWDATA bit is set.
 //
 // Parameter:
-// *userData - a pointer to the user's data struct that will hold acceleromter data.
 // *rawAccelData - a pointer to the data struct that holds acceleromter X/Y/Z data.
 //
-bool QMA6100P::convAccelData(outputData *userAccel, rawOutputData *rawAccelData)
+bool QMA6100P::readAccelRegisters(rawOutputData *rawAccelData)
 {
-  if (_range < 0) // If the G-range is unknown, read it
-  {
-    uint8_t regVal;
+  uint8_t tempRegData[6] = {0};
+  int16_t tempData = 0;
 
-    if(!readRegisterRegion(SFE_QMA6100P_FSR, &regVal, 1))
-      return false;
+  if(!readRegisterRegion(SFE_QMA6100P_DX_L, tempRegData, 6)) // Read 3 * 16-bit
+    return false;
 
-    sfe_qma6100p_fsr_bitfield_t fsr;
-    fsr.all = regVal;
+  {
+    SFE_AccelBusGuard guard(_busLock);
+    _newData = (tempRegData[0] & 0x1) | ((tempRegData[2] & 0x1) << 1) | ((tempRegData[4] & 0x1) << 2);
+  }
 
-    _range = fsr.bits.range; // Record the range
+  // check newData_X
+  if(tempRegData[0] & 0x1){
+    tempData = (int16_t)(((uint16_t)(tempRegData[1] << 8)) | (tempRegData[0]));
+    rawAccelData->xData = tempData >> 2;
   }
+  // check newData_Y
+  if(tempRegData[2] & 0x1){
+    tempData = (int16_t)(((uint16_t)(tempRegData[3] << 8)) | (tempRegData[2]));
+    rawAccelData->yData = tempData >> 2;
+  } 
+  // check newData_Z
+  if(tempRegData[4] & 0x1){
+    tempData = (int16_t)(((uint16_t)(tempRegData[5] << 8)) | (tempRegData[4]));
+    rawAccelData->zData = tempData >> 2;
+  }
+
+  return true;
+}
+
+// reads the g-range code from FSR
+bool QMA6100P::readRangeSetting(int *range)
+{
+  uint8_t regVal;
+
+  if(!readRegisterRegion(SFE_QMA6100P_FSR, &regVal, 1))
+    return false;
+
+  sfe_qma6100p_fsr_bitfield_t fsr;
+  fsr.all = regVal;
+
+  *range = fsr.bits.range;
 
-  switch (_range)
+  return true;
+}
+
+// g per count for a range code, 0 if the code is not a valid range
+float QMA6100P::getConversion(int range)
+{
+  switch (range)
   {
   case SFE_QMA6100P_RANGE2G:
-    userAccel->xData = (float)rawAccelData->xData * convRange2G;
-    userAccel->yData = (float)rawAccelData->yData * convRange2G;
-    userAccel->zData = (float)rawAccelData->zData * convRange2G;
-    break;
+    return convRange2G;
   case SFE_QMA6100P_RANGE4G:
-    userAccel->xData = (float)rawAccelData->xData * convRange4G;
-    userAccel->yData = (float)rawAccelData->yData * convRange4G;
-    userAccel->zData = (float)rawAccelData->zData * convRange4G;
-    break;
+    return convRange4G;
   case SFE_QMA6100P_RANGE8G:
-    userAccel->xData = (float)rawAccelData->xData * convRange8G;
-    userAccel->yData = (float)rawAccelData->yData * convRange8G;
-    userAccel->zData = (float)rawAccelData->zData * convRange8G;
-    break;
+    return convRange8G;
   case SFE_QMA6100P_RANGE16G:
-    userAccel->xData = (float)rawAccelData->xData * convRange16G;
-    userAccel->yData = (float)rawAccelData->yData * convRange16G;
-    userAccel->zData = (float)rawAccelData->zData * convRange16G;
-    break;
+    return convRange16G;
   case SFE_QMA6100P_RANGE32G:
-    userAccel->xData = (float)rawAccelData->xData * convRange32G;
-    userAccel->yData = (float)rawAccelData->yData * convRange32G;
-    userAccel->zData = (float)rawAccelData->zData * convRange32G;
-    break;
+    return convRange32G;
   default:
-    return false;
+    return 0;
   }
+}
+
+// number of frames waiting in the FIFO
+bool QMA6100P::readFifoLevel(uint16_t *frames)
+{
+  uint8_t tempVal;
+
+  if(!readRegisterRegion(SFE_QMA6100P_FIFO_ST, &tempVal, 1))
+    return false;
+
+  *frames = tempVal;
 
   return true;
 }
 
-void QMA6100P::setOffset(float x, float y, float z){
-  xOffset = x;
-  yOffset = y;
-  zOffset = z;
+// FIFO frames use the same 14 bit left aligned layout as the data registers
+void QMA6100P::decodeFifoFrame(const uint8_t *frame, rawOutputData *sample)
+{
+  sample->xData = (int16_t)(((uint16_t)(frame[1] << 8)) | frame[0]) >> 2;
+  sample->yData = (int16_t)(((uint16_t)(frame[3] << 8)) | frame[2]) >> 2;
+  sample->zData = (int16_t)(((uint16_t)(frame[5] << 8)) | frame[4]) >> 2;
 }
-
-
-void QMA6100P::offsetValues(float &x, float &y, float &z) {
-  x = x - xOffset;
-  y = y - yOffset;
-  z = z - zOffset;
-}
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include <Wire.h>
+#include "SFE_AccelCore.h"
 #include "QMA6100P_regs.h"
 
 #define QMA6100P_ADDRESS_HIGH 0x13
@@ -18,40 +18,37 @@
 #define SFE_QMA6100P_RANGE16G 0b1000
 #define SFE_QMA6100P_RANGE32G 0b1111
 
+// BW BW<4:0> - output data rate divider, ODR = MCLK / divider
+#define SFE_QMA6100P_DIV_512  0x00
+#define SFE_QMA6100P_DIV_256  0x01
+#define SFE_QMA6100P_DIV_128  0x02
+#define SFE_QMA6100P_DIV_64   0x03
+#define SFE_QMA6100P_DIV_32   0x04
+#define SFE_QMA6100P_DIV_1024 0x05
+#define SFE_QMA6100P_DIV_2048 0x06
+#define SFE_QMA6100P_DIV_4096 0x07
+
+// PM MCLK_SEL<3:0> - master clock, lower clocks draw less current
+#define SFE_QMA6100P_MCLK_102_4K 0x03
+#define SFE_QMA6100P_MCLK_51_2K  0x04
+#define SFE_QMA6100P_MCLK_25_6K  0x05
+#define SFE_QMA6100P_MCLK_12_8K  0x06
+#define SFE_QMA6100P_MCLK_6_4K   0x07
+
 #define SFE_QMA6100P_FIFO_MODE_BYPASS 0b00
 #define SFE_QMA6100P_FIFO_MODE_FIFO   0b01
 #define SFE_QMA6100P_FIFO_MODE_STREAM 0b10
 #define SFE_QMA6100P_FIFO_MODE_FIFO   0b11
 
-#define SENSORS_GRAVITY_EARTH (9.80665F)
-
-struct outputData
-{
-  float xData;
-  float yData;
-  float zData;
-};
-
-struct rawOutputData
+class QMA6100P : public SFE_AccelCore<QMA6100P>
 {
-  int16_t xData;
-  int16_t yData;
-  int16_t zData;
-};
+  friend class SFE_AccelCore<QMA6100P>;
 
-class QMA6100P
-{
 public:
+  QMA6100P() : SFE_AccelCore<QMA6100P>(QMA6100P_ADDRESS_HIGH) {}
 
-  bool begin();
-  bool calibrateOffsets();
+  bool begin(uint8_t address = QMA6100P_ADDRESS_HIGH, TwoWire &wirePort = Wire);
   uint8_t getUniqueID();
-  bool writeRegisterByte(uint8_t registerAddress, uint8_t data);
-  bool readRegisterRegion(uint8_t registerAddress, uint8_t* sensorData, int len);
-  
-
-  bool getAccelData(outputData *userData);
-  bool convAccelData(outputData *userAccel, rawOutputData *rawAccelData);
 
   // General Settings
   bool enableAccel(bool enable = true);
@@ -59,14 +56,25 @@ public:
   uint8_t getOperatingMode();
   bool setRange(uint8_t);
   bool enableDataEngine(bool enable = true);
-  bool getRawAccelRegisterData(rawOutputData *);
-  void offsetValues(float &x, float &y, float &z);
-  void setOffset(float x, float y, float z);
   bool setFifoMode(uint8_t fifo_mode);
+  bool setFifoWatermark(uint8_t frames);
+  bool enableFifoInterrupt(bool watermark = true, bool full = false, uint8_t pin = 1);
+  bool getFifoStatus(bool *watermark, bool *full, bool *overrun);
 
   uint8_t getRange();
 
-  rawOutputData rawAccelData;
+  // Output data rate / power
+  bool setBandwidth(uint8_t divider);
+  uint8_t getBandwidth();
+  bool setClock(uint8_t mclk);
+  uint8_t getClock();
+  bool setOutputDataRate(uint8_t mclk, uint8_t divider);
+  static uint32_t getSamplePeriod(uint8_t mclk, uint8_t divider);
+
+  // Motion detection
+  bool enableMotionDetect(uint8_t threshold, uint8_t duration = 0, bool enable = true, uint8_t pin = 0);
+  bool getMotionStatus(bool *motion);
+  uint8_t getNewDataFlags();
 
   // QMA6100P conversion values
   const double convRange2G = .000244;
@@ -75,10 +83,18 @@ public:
   const double convRange16G = .001950;
   const double convRange32G = .003910;
 
-  float xOffset = 0.0;
-  float yOffset = 0.0;
-  float zOffset = 0.0;
-
 protected:
-  int _range = -1; // Keep a local copy of the range. Default to "unknown" (-1).
+  // SFE_AccelCore backend
+  bool readAccelRegisters(rawOutputData *rawAccelData);
+  bool readRangeSetting(int *range);
+  float getConversion(int range);
+  bool readFifoLevel(uint16_t *frames);
+  uint8_t fifoDataRegister() { return SFE_QMA6100P_FIFO_DATA; }
+  uint8_t fifoFrameBytes() { return 6; }
+  void decodeFifoFrame(const uint8_t *frame, rawOutputData *sample);
+  bool isConfigRegister(uint8_t reg) { return reg != SFE_QMA6100P_SR; }
+  bool isDestructiveRead(uint8_t reg) { return reg == SFE_QMA6100P_FIFO_DATA; }
+  uint8_t sentinelRegister() { return SFE_QMA6100P_PM; } // 0x00 after power-on, mode bit set once enabled
+
+  uint8_t _newData = 0; // NEWDATA bits of the last output register read, x = bit 0
 };
\ No newline at end of file
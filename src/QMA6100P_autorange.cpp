@@ -0,0 +1,282 @@
+#include "QMA6100P_autorange.h"
+
+// Range codes from narrowest to widest
+static const uint8_t rangeLadder[] = {
+  SFE_QMA6100P_RANGE2G,
+  SFE_QMA6100P_RANGE4G,
+  SFE_QMA6100P_RANGE8G,
+  SFE_QMA6100P_RANGE16G,
+  SFE_QMA6100P_RANGE32G,
+};
+
+#define SFE_QMA6100P_RANGE_STEPS (int8_t)(sizeof(rangeLadder) / sizeof(rangeLadder[0]))
+
+QMA6100P_AutoRange::QMA6100P_AutoRange(QMA6100P &sensor) : _sensor(sensor)
+{
+}
+
+// position of a range code in the ladder, -1 if it is not a range
+int8_t QMA6100P_AutoRange::rangeIndex(uint8_t range)
+{
+  for (int8_t i = 0; i < SFE_QMA6100P_RANGE_STEPS; i++)
+  {
+    if (rangeLadder[i] == range)
+      return i;
+  }
+
+  return -1;
+}
+
+//////////////////////////////////////////////////
+// begin()
+//
+// Sets the starting range and clears the quiet counter and the
+// polled sample, which is then taken to be at the starting range.
+//
+// Parameter:
+// range - SFE_QMA6100P_RANGE2G to SFE_QMA6100P_RANGE32G
+//
+bool QMA6100P_AutoRange::begin(uint8_t range)
+{
+  int8_t index = rangeIndex(range);
+  if (index < 0)
+    return false;
+
+  if (!stepTo(index, false))
+    return false;
+
+  _oldFrames = 0;
+  _switches = 0;
+
+  _polled = rawOutputData{0, 0, 0};
+  for (uint8_t a = 0; a < 3; a++)
+    _axisRange[a] = rangeLadder[index];
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setLimits()
+//
+// Restricts the ranges the auto-ranger may select.
+//
+bool QMA6100P_AutoRange::setLimits(uint8_t minRange, uint8_t maxRange)
+{
+  int8_t minIndex = rangeIndex(minRange);
+  int8_t maxIndex = rangeIndex(maxRange);
+
+  if (minIndex < 0 || maxIndex < minIndex)
+    return false;
+
+  _minIndex = minIndex;
+  _maxIndex = maxIndex;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setThresholds()
+//
+// Parameter:
+// highPercent - largest axis, in percent of full scale, that steps the range up
+// lowPercent - largest axis, in percent of full scale, that counts as quiet.
+//              Keep it below half of highPercent so the narrower range is not
+//              immediately near full scale again.
+//
+void QMA6100P_AutoRange::setThresholds(uint8_t highPercent, uint8_t lowPercent)
+{
+  if (highPercent > 100)
+    highPercent = 100;
+  if (lowPercent > highPercent / 2)
+    lowPercent = highPercent / 2;
+
+  _highCounts = SFE_QMA6100P_FULL_SCALE_COUNTS * (int32_t)highPercent / 100;
+  _lowCounts = SFE_QMA6100P_FULL_SCALE_COUNTS * (int32_t)lowPercent / 100;
+}
+
+// consecutive quiet samples before stepping down one range
+void QMA6100P_AutoRange::setQuietSamples(uint16_t samples)
+{
+  _quietSamples = samples;
+}
+
+//////////////////////////////////////////////////
+// stepTo()
+//
+// Writes a new range. With countFifo the frames still waiting in the
+// FIFO are remembered so they keep the old range tag.
+//
+bool QMA6100P_AutoRange::stepTo(int8_t index, bool countFifo)
+{
+  uint8_t oldRange = rangeLadder[_index];
+
+  if (!_sensor.setRange(rangeLadder[index]))
+    return false;
+
+  if (countFifo)
+  {
+    uint16_t frames = 0;
+    if (!_sensor.getFifoLevel(&frames))
+      return false;
+
+    _oldRange = oldRange;
+    _oldFrames = frames;
+  }
+
+  if (index != _index)
+    _switches++;
+
+  _index = index;
+  _quietCount = 0;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// update()
+//
+// Runs the switching rules over samples captured at the current
+// range. Stops at the first switch since the rest of the block was
+// captured at the old range.
+//
+// Returns 1 if the range changed, 0 if not, -1 on a bus error.
+//
+int QMA6100P_AutoRange::update(const rawOutputData *samples, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    int16_t peak = 0;
+    const int16_t axes[] = {samples[i].xData, samples[i].yData, samples[i].zData};
+
+    for (uint8_t a = 0; a < 3; a++)
+    {
+      int16_t mag = axes[a] < 0 ? -axes[a] : axes[a]; // 14 bit, cannot overflow
+      if (mag > peak)
+        peak = mag;
+    }
+
+    if (peak >= _highCounts)
+    {
+      if (_index < _maxIndex)
+        return stepTo(_index + 1, true) ? 1 : -1;
+
+      _quietCount = 0;
+    }
+    else if (peak < _lowCounts)
+    {
+      if (_quietCount < _quietSamples)
+        _quietCount++;
+
+      if (_quietCount >= _quietSamples && _index > _minIndex)
+        return stepTo(_index - 1, true) ? 1 : -1;
+    }
+    else
+    {
+      _quietCount = 0;
+    }
+  }
+
+  return 0;
+}
+
+//////////////////////////////////////////////////
+// getFifoData()
+//
+// Drains the FIFO, tags each sample with its range and applies the
+// switching rules.
+//
+// Parameter:
+// *samples - array that receives the raw samples, oldest first
+// *ranges - array that receives the range code of each sample, may be nullptr
+// maxSamples - size of both arrays
+//
+// Returns the number of samples read, or -1 on a bus error.
+//
+int QMA6100P_AutoRange::getFifoData(rawOutputData *samples, uint8_t *ranges, int maxSamples)
+{
+  int n = _sensor.getFifoData(samples, maxSamples);
+  if (n <= 0)
+    return n;
+
+  // Frames captured before the last switch come out first
+  int old = n < (int)_oldFrames ? n : (int)_oldFrames;
+  uint8_t range = rangeLadder[_index];
+
+  if (ranges != nullptr)
+  {
+    for (int i = 0; i < n; i++)
+      ranges[i] = i < old ? _oldRange : range;
+  }
+
+  _oldFrames -= old;
+
+  if (update(&samples[old], n - old) < 0)
+    return -1;
+
+  return n;
+}
+
+//////////////////////////////////////////////////
+// getAccelData()
+//
+// Polled version: reads one sample and converts each axis with the
+// range it was captured at. The switching rules only run once every
+// axis has been refreshed at the current range.
+//
+// Parameter:
+// *userData - receives the sample in g
+// *range - optional, receives the range code of the sample; the old
+//          range while any axis still predates the last switch
+//
+bool QMA6100P_AutoRange::getAccelData(outputData *userData, uint8_t *range)
+{
+  static float outputData::*const axis[] = {&outputData::xData, &outputData::yData, &outputData::zData};
+
+  uint8_t current = rangeLadder[_index];
+
+  if (!_sensor.getRawAccelRegisterData(&_polled))
+    return false;
+
+  uint8_t fresh = _sensor.getNewDataFlags();
+
+  if (!_sensor.convAccelData(userData, &_polled, current))
+    return false;
+
+  uint8_t captured = current;
+
+  for (uint8_t a = 0; a < 3; a++)
+  {
+    if (fresh & (1 << a))
+      _axisRange[a] = current;
+
+    if (_axisRange[a] != current)
+    {
+      outputData old;
+      if (!_sensor.convAccelData(&old, &_polled, _axisRange[a]))
+        return false;
+
+      userData->*axis[a] = old.*axis[a];
+      captured = _axisRange[a];
+    }
+  }
+
+  if (range != nullptr)
+    *range = captured;
+
+  if (captured == current && update(&_polled, 1) < 0)
+    return false;
+
+  return true;
+}
+
+// range the next sample will be captured at
+uint8_t QMA6100P_AutoRange::getRange()
+{
+  return rangeLadder[_index];
+}
+
+// number of range changes since begin()
+uint32_t QMA6100P_AutoRange::getSwitchCount()
+{
+  return _switches;
+}
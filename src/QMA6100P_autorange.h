@@ -0,0 +1,61 @@
+// The following class implements automatic range switching for the QMA6100P.
+// A sample near full scale steps the range up immediately; a sustained quiet
+// period steps it down again, so the narrowest range that does not clip is used.
+//
+// Every sample returned is tagged with the range it was captured at. Frames
+// already in the FIFO when the range changes keep the old range tag, so
+// converting with convAccelData(out, raw, range) stays correct across switches.
+// The tag boundary is taken from the FIFO level read right after the range
+// write and can be off by the one frame captured during that read.
+//
+// The output registers only refresh an axis that has new data, so after a
+// switch a polled sample can mix axes from both ranges. getAccelData()
+// converts each axis with the range it was captured at and tags the sample
+// with the old range until every axis has new data.
+
+#pragma once
+
+#include "QMA6100P.h"
+
+#define SFE_QMA6100P_FULL_SCALE_COUNTS 8191 // 14 bit output
+
+class QMA6100P_AutoRange
+{
+public:
+  QMA6100P_AutoRange(QMA6100P &sensor);
+
+  bool begin(uint8_t range = SFE_QMA6100P_RANGE8G);
+  bool setLimits(uint8_t minRange, uint8_t maxRange);
+  void setThresholds(uint8_t highPercent, uint8_t lowPercent);
+  void setQuietSamples(uint16_t samples);
+
+  int getFifoData(rawOutputData *samples, uint8_t *ranges, int maxSamples);
+  bool getAccelData(outputData *userData, uint8_t *range = nullptr);
+  int update(const rawOutputData *samples, int count);
+
+  uint8_t getRange();
+  uint32_t getSwitchCount();
+
+protected:
+  static int8_t rangeIndex(uint8_t range);
+  bool stepTo(int8_t index, bool countFifo);
+
+  QMA6100P &_sensor;
+
+  int8_t _index = 2;    // position in the range ladder, 8g
+  int8_t _minIndex = 0; // 2g
+  int8_t _maxIndex = 4; // 32g
+
+  int16_t _highCounts = SFE_QMA6100P_FULL_SCALE_COUNTS * 90L / 100; // step up at or above
+  int16_t _lowCounts = SFE_QMA6100P_FULL_SCALE_COUNTS * 35L / 100;  // quiet below
+  uint16_t _quietSamples = 256;
+  uint16_t _quietCount = 0;
+
+  uint8_t _oldRange = 0;    // range of frames still in the FIFO from before a switch
+  uint16_t _oldFrames = 0;
+
+  rawOutputData _polled = {0, 0, 0}; // last polled sample, axes without new data keep their value
+  uint8_t _axisRange[3] = {SFE_QMA6100P_RANGE8G, SFE_QMA6100P_RANGE8G, SFE_QMA6100P_RANGE8G};
+
+  uint32_t _switches = 0;
+};
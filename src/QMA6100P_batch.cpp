@@ -0,0 +1,141 @@
+#include "QMA6100P_batch.h"
+
+QMA6100P_Batch::QMA6100P_Batch(QMA6100P &sensor) : _sensor(sensor)
+{
+}
+
+//////////////////////////////////////////////////
+// begin()
+//
+// Puts the FIFO in STREAM mode, sets the watermark and routes the
+// watermark interrupt to an INT pin. The sensor's output data rate
+// should already be set; it is read back to report latency.
+//
+// Each batch is read in ceil(watermark * 6 / SFE_ACCEL_I2C_BUFFER_LENGTH)
+// transactions: 1 up to 5 frames with a 32 byte Wire buffer, 7 for 32
+// frames. Larger batches still save wake-ups, not bus transactions.
+//
+// Parameter:
+// watermark - frames per batch, 1 to 64
+// pin - sensor INT pin, 1 or 2
+// mcuPin - MCU pin wired to that INT pin. When given and still high
+//          after a drain, service() reads the FIFO level so a FIFO that
+//          is still above the watermark (no new edge) is not missed. The
+//          level decides: the pin may also carry data-ready or motion.
+//
+bool QMA6100P_Batch::begin(uint8_t watermark, uint8_t pin, int mcuPin)
+{
+  uint8_t mclk = _sensor.getClock();
+  uint8_t divider = _sensor.getBandwidth();
+
+  _samplePeriod = QMA6100P::getSamplePeriod(mclk, divider);
+  if (_samplePeriod == 0)
+    return false;
+
+  if (!_sensor.setFifoMode(SFE_QMA6100P_FIFO_MODE_STREAM))
+    return false;
+
+  if (!_sensor.setFifoWatermark(watermark))
+    return false;
+
+  if (!_sensor.enableFifoInterrupt(true, false, pin))
+    return false;
+
+  _watermark = watermark;
+  _mcuPin = mcuPin;
+  _pending = false;
+
+  resetWakeRate();
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// handleInterrupt()
+//
+// Call from the INT pin interrupt handler. Only sets a flag and
+// counts the wake-up; no bus access is done in interrupt context.
+//
+void QMA6100P_Batch::handleInterrupt()
+{
+  _pending = true;
+  _wakeups++;
+}
+
+// true when a batch is waiting to be drained
+bool QMA6100P_Batch::pending()
+{
+  return _pending;
+}
+
+//////////////////////////////////////////////////
+// service()
+//
+// Drains one batch if the watermark interrupt has fired.
+//
+// Parameter:
+// *samples - array of at least getWatermark() entries
+//
+// Returns the number of samples read (0 if nothing was pending),
+// or -1 on a bus error.
+//
+int QMA6100P_Batch::service(rawOutputData *samples)
+{
+  if (!_pending)
+    return 0;
+
+  _pending = false;
+
+  int count = _sensor.readFifoFrames(samples, _watermark);
+  if (count < 0)
+    return -1;
+
+  // A full batch still waiting raises no new edge. The pin is only a hint,
+  // since it may be shared with other interrupts, and the part reads zeros
+  // past its fill level, so the level decides.
+  if (_mcuPin >= 0 && digitalRead(_mcuPin) == HIGH)
+  {
+    uint16_t frames;
+    if (_sensor.getFifoLevel(&frames) && frames >= _watermark)
+      _pending = true;
+  }
+
+  return count;
+}
+
+uint8_t QMA6100P_Batch::getWatermark()
+{
+  return _watermark;
+}
+
+// time in microseconds from the first sample of a batch to the wake-up
+uint32_t QMA6100P_Batch::getLatency()
+{
+  return _samplePeriod * _watermark;
+}
+
+// wake-ups per second implied by the output data rate and watermark
+float QMA6100P_Batch::getExpectedWakeRate()
+{
+  uint32_t latency = getLatency();
+  if (latency == 0)
+    return 0;
+
+  return 1000000.0 / (float)latency;
+}
+
+// wake-ups per second measured since begin() or resetWakeRate()
+float QMA6100P_Batch::getWakeRate()
+{
+  unsigned long elapsed = millis() - _rateStart;
+  if (elapsed == 0)
+    return 0;
+
+  return (float)_wakeups * 1000.0 / (float)elapsed;
+}
+
+void QMA6100P_Batch::resetWakeRate()
+{
+  _wakeups = 0;
+  _rateStart = millis();
+}
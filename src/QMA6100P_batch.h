@@ -0,0 +1,39 @@
+// The following class implements sleep-until-batch operation for the QMA6100P.
+// The FIFO fills in STREAM mode while the MCU sleeps; the watermark interrupt
+// wakes it once a batch of frames is ready and service() drains exactly that
+// many frames without reading the FIFO level first. The drain is one bus
+// transaction per SFE_ACCEL_I2C_BUFFER_LENGTH / 6 frames, so a batch is a
+// single burst only if it fits the Wire buffer (5 frames with 32 bytes). Wake-ups are counted so
+// the latency / energy trade-off of a watermark setting can be measured.
+
+#pragma once
+
+#include "QMA6100P.h"
+
+class QMA6100P_Batch
+{
+public:
+  QMA6100P_Batch(QMA6100P &sensor);
+
+  bool begin(uint8_t watermark, uint8_t pin = 1, int mcuPin = -1);
+  void handleInterrupt();
+  bool pending();
+  int service(rawOutputData *samples);
+
+  uint8_t getWatermark();
+  uint32_t getLatency();
+  float getExpectedWakeRate();
+  float getWakeRate();
+  void resetWakeRate();
+
+protected:
+  QMA6100P &_sensor;
+
+  uint8_t _watermark = 0;
+  int _mcuPin = -1;           // MCU pin wired to the INT pin, -1 if not known
+  uint32_t _samplePeriod = 0; // microseconds
+
+  volatile bool _pending = false;
+  volatile uint32_t _wakeups = 0;
+  unsigned long _rateStart = 0; // millis() when counting started
+};
@@ -0,0 +1,226 @@
+#include "QMA6100P_capture.h"
+
+QMA6100P_Capture::QMA6100P_Capture(QMA6100P &sensor) : _sensor(sensor)
+{
+}
+
+//////////////////////////////////////////////////
+// begin()
+//
+// Hands the capture buffer to the engine. It must hold
+// preSamples + postSamples entries and stay valid while capturing.
+//
+// Parameter:
+// *buffer - caller-provided storage, used as a ring
+// preSamples - samples kept before the trigger
+// postSamples - samples collected from the trigger on, at least 1
+//
+bool QMA6100P_Capture::begin(rawOutputData *buffer, uint16_t preSamples, uint16_t postSamples)
+{
+  if (buffer == nullptr || postSamples == 0)
+    return false;
+
+  if ((uint32_t)preSamples + postSamples > UINT16_MAX)
+    return false;
+
+  _buffer = buffer;
+  _pre = preSamples;
+  _post = postSamples;
+  _size = preSamples + postSamples;
+  _state = SFE_QMA6100P_CAPTURE_IDLE;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setThreshold()
+//
+// Sets the |a| level, in g, that triggers a capture. Takes effect
+// at the next arm().
+//
+void QMA6100P_Capture::setThreshold(float g)
+{
+  _thresholdG = g;
+}
+
+//////////////////////////////////////////////////
+// arm()
+//
+// Restarts the FIFO in STREAM mode (which also clears it) and starts
+// filling the pre-trigger ring.
+//
+bool QMA6100P_Capture::arm()
+{
+  if (_buffer == nullptr)
+    return false;
+
+  // Work out the threshold in counts for the current range once
+  rawOutputData unit = {1, 0, 0};
+  outputData unitG;
+  if (!_sensor.convAccelData(&unitG, &unit))
+    return false;
+
+  float counts = _thresholdG / unitG.xData;
+  float countsSq = counts * counts;
+  _thresholdSq = countsSq >= 4294967295.0f ? UINT32_MAX : (uint32_t)countsSq;
+
+  if (!_sensor.setFifoMode(SFE_QMA6100P_FIFO_MODE_STREAM))
+    return false;
+
+  _head = 0;
+  _filled = 0;
+  _start = 0;
+  _preCaptured = 0;
+  _postCaptured = 0;
+  _triggerFlag = false;
+  _state = SFE_QMA6100P_CAPTURE_ARMED;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// notifyTrigger()
+//
+// Forces a trigger, e.g. from the handler of the INT pin that
+// enableMotionDetect() routed any-motion to. The trigger is placed
+// on the newest sample of the next FIFO drain.
+//
+void QMA6100P_Capture::notifyTrigger()
+{
+  _triggerFlag = true;
+}
+
+// freezes the pre-trigger window around buffer index
+void QMA6100P_Capture::trigger(uint16_t index)
+{
+  _preCaptured = _filled < _pre ? _filled : _pre;
+  _start = (index + _size - _preCaptured) % _size;
+  _postCaptured = 0;
+  _state = SFE_QMA6100P_CAPTURE_TRIGGERED;
+}
+
+//////////////////////////////////////////////////
+// update()
+//
+// Drains the FIFO into the ring and looks for the trigger. Call it
+// often enough that the 64 frame FIFO does not overrun.
+//
+// While armed, at most postSamples are drained per read so samples
+// after a trigger can never overwrite the pre-trigger window.
+//
+// Returns the number of samples drained, or -1 on a bus error.
+//
+int QMA6100P_Capture::update()
+{
+  if (_state != SFE_QMA6100P_CAPTURE_ARMED && _state != SFE_QMA6100P_CAPTURE_TRIGGERED)
+    return 0;
+
+  bool forced = _triggerFlag;
+  _triggerFlag = false;
+
+  int total = 0;
+
+  while (_state != SFE_QMA6100P_CAPTURE_COMPLETE)
+  {
+    uint16_t limit = _size - _head; // contiguous space up to the end of the ring
+    uint16_t cap = (_state == SFE_QMA6100P_CAPTURE_ARMED) ? _post : _post - _postCaptured;
+    if (limit > cap)
+      limit = cap;
+
+    int n = _sensor.getFifoData(&_buffer[_head], limit);
+    if (n < 0)
+      return -1;
+    if (n == 0)
+      break;
+
+    for (int i = 0; i < n; i++)
+    {
+      uint16_t index = _head + i;
+
+      if (_state == SFE_QMA6100P_CAPTURE_ARMED)
+      {
+        const rawOutputData &s = _buffer[index];
+        uint32_t magSq = (uint32_t)((int32_t)s.xData * s.xData) + (uint32_t)((int32_t)s.yData * s.yData) + (uint32_t)((int32_t)s.zData * s.zData);
+
+        if (magSq >= _thresholdSq)
+          trigger(index);
+        else if (_filled < _size)
+          _filled++;
+      }
+
+      if (_state == SFE_QMA6100P_CAPTURE_TRIGGERED)
+        _postCaptured++;
+    }
+
+    total += n;
+    _head = (_head + n) % _size;
+
+    if (_state == SFE_QMA6100P_CAPTURE_TRIGGERED && _postCaptured >= _post)
+      _state = SFE_QMA6100P_CAPTURE_COMPLETE;
+
+    if (n < limit)
+      break; // FIFO is empty
+  }
+
+  // A forced trigger lands on the newest sample of the whole drain
+  if (forced && _state == SFE_QMA6100P_CAPTURE_ARMED)
+  {
+    if (total == 0)
+    {
+      _triggerFlag = true; // nothing drained, try again next time
+    }
+    else
+    {
+      if (_filled > 0)
+        _filled--; // the trigger sample was counted as pre-trigger
+
+      trigger((_head + _size - 1) % _size);
+      _postCaptured = 1;
+
+      if (_postCaptured >= _post)
+        _state = SFE_QMA6100P_CAPTURE_COMPLETE;
+    }
+  }
+
+  return total;
+}
+
+// SFE_QMA6100P_CAPTURE_xxx
+uint8_t QMA6100P_Capture::getState()
+{
+  return _state;
+}
+
+bool QMA6100P_Capture::isComplete()
+{
+  return _state == SFE_QMA6100P_CAPTURE_COMPLETE;
+}
+
+// samples in the captured window
+uint16_t QMA6100P_Capture::getLength()
+{
+  return _preCaptured + _postCaptured;
+}
+
+// position of the trigger sample within the window, in time order
+uint16_t QMA6100P_Capture::getTriggerIndex()
+{
+  return _preCaptured;
+}
+
+// buffer index of the oldest sample in the window
+uint16_t QMA6100P_Capture::getStartIndex()
+{
+  return _start;
+}
+
+//////////////////////////////////////////////////
+// getSample()
+//
+// Returns sample n of the window in time order without moving the
+// data. getSample(getTriggerIndex()) is the trigger sample.
+//
+const rawOutputData &QMA6100P_Capture::getSample(uint16_t n)
+{
+  return _buffer[(_start + n) % _size];
+}
@@ -0,0 +1,56 @@
+// The following class implements pre-trigger event capture for the QMA6100P.
+// The FIFO runs in STREAM mode and is drained straight into a caller-provided
+// buffer that is used as a ring. When a sample crosses the threshold (or a
+// motion interrupt is flagged) the ring stops sliding and collects the
+// post-trigger samples in place, so every sample is copied exactly once: from
+// the bus into the caller's buffer.
+
+#pragma once
+
+#include "QMA6100P.h"
+
+#define SFE_QMA6100P_CAPTURE_IDLE      0
+#define SFE_QMA6100P_CAPTURE_ARMED     1
+#define SFE_QMA6100P_CAPTURE_TRIGGERED 2
+#define SFE_QMA6100P_CAPTURE_COMPLETE  3
+
+class QMA6100P_Capture
+{
+public:
+  QMA6100P_Capture(QMA6100P &sensor);
+
+  bool begin(rawOutputData *buffer, uint16_t preSamples, uint16_t postSamples);
+  void setThreshold(float g);
+  bool arm();
+  void notifyTrigger();
+  int update();
+
+  uint8_t getState();
+  bool isComplete();
+  uint16_t getLength();
+  uint16_t getTriggerIndex();
+  uint16_t getStartIndex();
+  const rawOutputData &getSample(uint16_t n);
+
+protected:
+  void trigger(uint16_t index);
+
+  QMA6100P &_sensor;
+
+  rawOutputData *_buffer = nullptr;
+  uint16_t _size = 0; // preSamples + postSamples
+  uint16_t _pre = 0;
+  uint16_t _post = 0;
+
+  uint8_t _state = SFE_QMA6100P_CAPTURE_IDLE;
+  uint16_t _head = 0;         // next buffer index to write
+  uint16_t _filled = 0;       // valid samples in the ring, saturates at _size
+  uint16_t _start = 0;        // buffer index of the oldest sample in the window
+  uint16_t _preCaptured = 0;  // samples before the trigger, at most _pre
+  uint16_t _postCaptured = 0; // trigger sample and the ones after it
+
+  float _thresholdG = 2.0;
+  uint32_t _thresholdSq = 0; // |a|^2 in raw counts
+
+  volatile bool _triggerFlag = false;
+};
@@ -0,0 +1,315 @@
+#include "QMA6100P_governor.h"
+
+// Default ladder, lowest power first: 12.5 Hz, 50 Hz, 200 Hz, 800 Hz
+static const odrProfile defaultProfiles[] = {
+  {SFE_QMA6100P_MCLK_6_4K, SFE_QMA6100P_DIV_512},
+  {SFE_QMA6100P_MCLK_12_8K, SFE_QMA6100P_DIV_256},
+  {SFE_QMA6100P_MCLK_51_2K, SFE_QMA6100P_DIV_256},
+  {SFE_QMA6100P_MCLK_102_4K, SFE_QMA6100P_DIV_128},
+};
+
+QMA6100P_Governor::QMA6100P_Governor(QMA6100P &sensor) : _sensor(sensor)
+{
+  setProfiles(defaultProfiles, sizeof(defaultProfiles) / sizeof(defaultProfiles[0]));
+  resetWindow();
+}
+
+//////////////////////////////////////////////////
+// begin()
+//
+// Programs the starting level and restarts the sample clock at zero.
+//
+// Parameter:
+// level - index into the profile ladder to start from
+//
+bool QMA6100P_Governor::begin(uint8_t level)
+{
+  _quietWindows = 0;
+  _motionFlag = false;
+
+  if (!setLevel(level))
+    return false;
+
+  _timestamp = 0;
+  _oldRemaining = 0;
+  _gapPending = false;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setProfiles()
+//
+// Replaces the ladder of master clock / divider pairs. Profiles must
+// be ordered from the lowest to the highest output data rate.
+//
+// Parameter:
+// *profiles - array of profiles, copied
+// numProfiles - number of entries, 1 to SFE_QMA6100P_GOVERNOR_MAX_LEVELS
+//
+bool QMA6100P_Governor::setProfiles(const odrProfile *profiles, uint8_t numProfiles)
+{
+  if (numProfiles == 0 || numProfiles > SFE_QMA6100P_GOVERNOR_MAX_LEVELS)
+    return false;
+
+  for (uint8_t i = 0; i < numProfiles; i++)
+  {
+    uint32_t period = QMA6100P::getSamplePeriod(profiles[i].mclk, profiles[i].divider);
+    if (period == 0)
+      return false;
+
+    _profiles[i] = profiles[i];
+    _periods[i] = period;
+  }
+
+  _numProfiles = numProfiles;
+
+  if (_level >= _numProfiles)
+    _level = _numProfiles - 1;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setThresholds()
+//
+// Sets the hysteresis band. A window whose largest per-axis
+// peak-to-peak exceeds upG steps the rate up; windows below downG
+// count towards stepping it down.
+//
+void QMA6100P_Governor::setThresholds(float upG, float downG)
+{
+  _upThreshold = upG;
+  _downThreshold = downG < upG ? downG : upG;
+}
+
+// number of samples in each statistics window
+void QMA6100P_Governor::setWindowLength(uint16_t samples)
+{
+  _windowLength = samples > 0 ? samples : 1;
+  resetWindow();
+}
+
+// number of consecutive quiet windows before stepping down one level
+void QMA6100P_Governor::setHoldWindows(uint8_t windows)
+{
+  _holdWindows = windows;
+}
+
+// read the any-motion status once per window while below the top level
+void QMA6100P_Governor::enableMotionPolling(bool enable)
+{
+  _pollMotion = enable;
+}
+
+//////////////////////////////////////////////////
+// notifyMotion()
+//
+// Flags a motion event, e.g. from the handler of the INT pin that
+// enableMotionDetect() routed any-motion to. The governor jumps to
+// the top level at the end of the current window.
+//
+void QMA6100P_Governor::notifyMotion()
+{
+  _motionFlag = true;
+}
+
+//////////////////////////////////////////////////
+// update()
+//
+// Feeds a block of samples to the governor, which may change the
+// output data rate. Samples captured before a change (the rest of the
+// block and the frames still in the FIFO) keep the old period, and
+// the standby gap of the change is added once, so the timestamps stay
+// continuous across a change.
+//
+// Parameter:
+// *samples - raw samples, oldest first
+// count - number of samples
+// *timestamps - optional, receives the microsecond timestamp of each sample
+//
+bool QMA6100P_Governor::update(const rawOutputData *samples, int count, uint32_t *timestamps)
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (timestamps != nullptr)
+      timestamps[i] = _timestamp;
+
+    const rawOutputData &s = samples[i];
+
+    if (s.xData < _min.xData) _min.xData = s.xData;
+    if (s.xData > _max.xData) _max.xData = s.xData;
+    if (s.yData < _min.yData) _min.yData = s.yData;
+    if (s.yData > _max.yData) _max.yData = s.yData;
+    if (s.zData < _min.zData) _min.zData = s.zData;
+    if (s.zData > _max.zData) _max.zData = s.zData;
+
+    if (++_windowCount >= _windowLength)
+    {
+      _blockRemaining = count - i - 1;
+      bool ok = evaluateWindow();
+      _blockRemaining = 0;
+
+      if (!ok)
+        return false;
+    }
+
+    if (_oldRemaining > 0)
+    {
+      _oldRemaining--;
+      _timestamp += _oldPeriod;
+    }
+    else if (_gapPending)
+    {
+      _gapPending = false;
+      _timestamp += _restartGap;
+    }
+    else
+    {
+      _timestamp += _periods[_level];
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// evaluateWindow()
+//
+// Converts the window's peak-to-peak to g once per window and
+// applies the hysteresis rules.
+//
+bool QMA6100P_Governor::evaluateWindow()
+{
+  rawOutputData span;
+  outputData spanG;
+
+  // The axes are 14 bit so the spans always fit in an int16_t
+  span.xData = _max.xData - _min.xData;
+  span.yData = _max.yData - _min.yData;
+  span.zData = _max.zData - _min.zData;
+
+  resetWindow();
+
+  if (!_sensor.convAccelData(&spanG, &span))
+    return false;
+
+  _activity = spanG.xData;
+  if (spanG.yData > _activity) _activity = spanG.yData;
+  if (spanG.zData > _activity) _activity = spanG.zData;
+
+  uint8_t top = _numProfiles - 1;
+  bool motion = _motionFlag;
+  _motionFlag = false;
+
+  if (_pollMotion && !motion && _level < top)
+  {
+    if (!_sensor.getMotionStatus(&motion))
+      return false;
+  }
+
+  if (motion)
+  {
+    _quietWindows = 0;
+    if (_level < top)
+      return setLevel(top);
+    return true;
+  }
+
+  if (_activity > _upThreshold)
+  {
+    _quietWindows = 0;
+    if (_level < top)
+      return setLevel(_level + 1);
+    return true;
+  }
+
+  if (_activity < _downThreshold)
+  {
+    if (++_quietWindows >= _holdWindows && _level > 0)
+    {
+      _quietWindows = 0;
+      return setLevel(_level - 1);
+    }
+    return true;
+  }
+
+  _quietWindows = 0;
+  return true;
+}
+
+void QMA6100P_Governor::resetWindow()
+{
+  _windowCount = 0;
+  _min.xData = _min.yData = _min.zData = INT16_MAX;
+  _max.xData = _max.yData = _max.zData = INT16_MIN;
+}
+
+//////////////////////////////////////////////////
+// setLevel()
+//
+// Programs a level of the ladder into the sensor. The sample clock is
+// not touched so timestamps continue from where they were.
+//
+// The frames already in the FIFO were captured at the old rate; their
+// count is read right after the change (it can be off by the one frame
+// captured during that read). The first new sample is taken to follow
+// the last old one by half an old period (the mean time to the stop),
+// the standby time of the change and one new period.
+//
+bool QMA6100P_Governor::setLevel(uint8_t level)
+{
+  if (level >= _numProfiles)
+    return false;
+
+  unsigned long start = micros();
+
+  if (!_sensor.setOutputDataRate(_profiles[level].mclk, _profiles[level].divider))
+    return false;
+
+  uint32_t standby = micros() - start;
+
+  if (level != _level)
+  {
+    uint16_t frames = 0;
+    if (!_sensor.getFifoLevel(&frames))
+      return false;
+
+    // Everything not yet stamped was captured before this change. If an
+    // earlier change is still pending its period is kept for all of it.
+    if (!_gapPending)
+      _oldPeriod = _periods[_level];
+
+    _oldRemaining = _blockRemaining + frames;
+    _restartGap = _oldPeriod / 2 + standby + _periods[level];
+    _gapPending = true;
+  }
+
+  _level = level;
+  resetWindow();
+
+  return true;
+}
+
+uint8_t QMA6100P_Governor::getLevel()
+{
+  return _level;
+}
+
+// nominal microseconds between samples at the current level
+uint32_t QMA6100P_Governor::getSamplePeriod()
+{
+  return _periods[_level];
+}
+
+// timestamp the next sample passed to update() will receive
+uint32_t QMA6100P_Governor::getTimestamp()
+{
+  return _timestamp;
+}
+
+// largest per-axis peak-to-peak of the last completed window, in g
+float QMA6100P_Governor::getActivity()
+{
+  return _activity;
+}
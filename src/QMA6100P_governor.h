@@ -0,0 +1,75 @@
+// The following class implements an activity-adaptive output data rate governor
+// for the QMA6100P. It watches short windows of samples (and optionally the
+// any-motion engine) and steps the master clock / divider up while there is
+// something to measure and back down once the signal has been quiet for a while.
+
+#pragma once
+
+#include "QMA6100P.h"
+
+#define SFE_QMA6100P_GOVERNOR_MAX_LEVELS 8
+
+// One rung of the governor ladder
+struct odrProfile
+{
+  uint8_t mclk;    // SFE_QMA6100P_MCLK_xxx
+  uint8_t divider; // SFE_QMA6100P_DIV_xxx
+};
+
+class QMA6100P_Governor
+{
+public:
+  QMA6100P_Governor(QMA6100P &sensor);
+
+  bool begin(uint8_t level = 0);
+  bool setProfiles(const odrProfile *profiles, uint8_t numProfiles);
+  void setThresholds(float upG, float downG);
+  void setWindowLength(uint16_t samples);
+  void setHoldWindows(uint8_t windows);
+  void enableMotionPolling(bool enable = true);
+
+  bool update(const rawOutputData *samples, int count, uint32_t *timestamps = nullptr);
+  void notifyMotion();
+
+  bool setLevel(uint8_t level);
+  uint8_t getLevel();
+  uint32_t getSamplePeriod();
+  uint32_t getTimestamp();
+  float getActivity();
+
+protected:
+  bool evaluateWindow();
+  void resetWindow();
+
+  QMA6100P &_sensor;
+
+  odrProfile _profiles[SFE_QMA6100P_GOVERNOR_MAX_LEVELS];
+  uint32_t _periods[SFE_QMA6100P_GOVERNOR_MAX_LEVELS]; // microseconds per sample for each level
+  uint8_t _numProfiles = 0;
+  uint8_t _level = 0;
+
+  float _upThreshold = 0.05;   // peak-to-peak g that triggers a step up
+  float _downThreshold = 0.02; // peak-to-peak g that counts as quiet
+  uint16_t _windowLength = 16;
+  uint8_t _holdWindows = 8;
+  bool _pollMotion = false;
+
+  // Running window statistics, in raw counts
+  uint16_t _windowCount = 0;
+  uint8_t _quietWindows = 0;
+  rawOutputData _min;
+  rawOutputData _max;
+  float _activity = 0.0;
+
+  volatile bool _motionFlag = false;
+
+  uint32_t _timestamp = 0; // microseconds, continuous across level changes
+
+  // Samples captured at the old rate that are still to be stamped after a
+  // level change: the rest of the current block plus the FIFO contents
+  uint16_t _blockRemaining = 0;
+  uint16_t _oldRemaining = 0;
+  uint32_t _oldPeriod = 0;
+  uint32_t _restartGap = 0; // last old sample to first new sample
+  bool _gapPending = false;
+};
@@ -87,15 +87,21 @@ ANY_MOT_FIRST_X: 1, any_motion interrupt is triggered by X axis
 */
 typedef struct
 {
-  uint8_t no_mot : 1;
-  uint8_t step_flag : 1;
-  uint8_t blank : 2;
-  uint8_t any_mot_sign : 1;
-  uint8_t any_mot_first_z : 1;
-  uint8_t any_mot_first_y : 1;
   uint8_t any_mot_first_x : 1;
+  uint8_t any_mot_first_y : 1;
+  uint8_t any_mot_first_z : 1;
+  uint8_t any_mot_sign : 1;
+  uint8_t blank : 2;
+  uint8_t step_flag : 1;
+  uint8_t no_mot : 1;
 } sfe_qma6100p_int_st0_t;
 
+typedef union
+{
+  uint8_t all;
+  sfe_qma6100p_int_st0_t bits;
+} sfe_qma6100p_int_st0_bitfield_t;
+
 #define SFE_QMA6100P_INT_ST1  0x0a
 // Reports which function caused an interrupt
 /*
@@ -152,15 +158,21 @@ Q_TAP_INT: 1, quad tap is active
 */
 typedef struct
 {
-  uint8_t fifo_or : 1;
-  uint8_t fifo_wm_int : 1;
-  uint8_t fifo_full_int : 1;
-  uint8_t data_int : 1; // data ready int
-  uint8_t blank : 2;
-  uint8_t earin_flag : 1;
   uint8_t q_tap_int : 1;
+  uint8_t earin_flag : 1;
+  uint8_t blank : 2;
+  uint8_t data_int : 1; // data ready int
+  uint8_t fifo_full_int : 1;
+  uint8_t fifo_wm_int : 1;
+  uint8_t fifo_or : 1;
 } sfe_qma6100p_int_st2_t;
 
+typedef union
+{
+  uint8_t all;
+  sfe_qma6100p_int_st2_t bits;
+} sfe_qma6100p_int_st2_bitfield_t;
+
 #define SFE_QMA6100P_INT_ST3  0x0c
 
 #define SFE_QMA6100P_INT_ST4  0x0d
@@ -190,6 +202,25 @@ typedef union
 } sfe_qma6100p_fsr_bitfield_t;
 
 #define SFE_QMA6100P_BW 0x10
+/*
+BW<4:0>: output data rate divider, ODR = MCLK / divider (see SFE_QMA6100P_DIV_xxx)
+NLPF<1:0>: 00, no LPF
+           01, NLPF=2
+           10, NLPF=4
+           11, NLPF=8
+*/
+typedef struct
+{
+  uint8_t bw : 5;
+  uint8_t nlpf : 2;
+  uint8_t hpf : 1;
+} sfe_qma6100p_bw_t;
+
+typedef union
+{
+  uint8_t all;
+  sfe_qma6100p_bw_t bits;
+} sfe_qma6100p_bw_bitfield_t;
 
 #define SFE_QMA6100P_PM 0x11
 /* Read/write control register that controls the "MODE"
@@ -230,10 +261,11 @@ INT_DATA_EN: 1, enable data ready interrupt
 */
 typedef struct
 {
-  uint8_t int_fwm_en : 1;
-  uint8_t int_ffull_en : 1;
-  uint8_t int_data_en : 1;
   uint8_t blank : 4;
+  uint8_t int_data_en : 1;
+  uint8_t int_ffull_en : 1;
+  uint8_t int_fwm_en : 1;
+  uint8_t blank2 : 1;
 } sfe_qma6100p_int_en1_t;
 
 typedef union
@@ -243,6 +275,28 @@ typedef union
 } sfe_qma6100p_int_en1_bitfield_t;
 
 #define SFE_QMA6100P_INT_EN2  0x18
+/*
+NO_MOT_EN_Z/Y/X: 1, enable no_motion interrupt on Z/Y/X axis
+                 0, disable no_motion interrupt on Z/Y/X axis
+ANY_MOT_EN_Z/Y/X: 1, enable any_motion interrupt on Z/Y/X axis
+                  0, disable any_motion interrupt on Z/Y/X axis
+*/
+typedef struct
+{
+  uint8_t any_mot_en_x : 1;
+  uint8_t any_mot_en_y : 1;
+  uint8_t any_mot_en_z : 1;
+  uint8_t blank : 2;
+  uint8_t no_mot_en_x : 1;
+  uint8_t no_mot_en_y : 1;
+  uint8_t no_mot_en_z : 1;
+} sfe_qma6100p_int_en2_t;
+
+typedef union
+{
+  uint8_t all;
+  sfe_qma6100p_int_en2_t bits;
+} sfe_qma6100p_int_en2_bitfield_t;
 
 #define SFE_QMA6100P_INT_MAP0 0x19
 
@@ -263,13 +317,13 @@ INT1_ANY_MOT: 1, map any motion interrupt to INT1 pin
 */
 typedef struct
 {
-  uint8_t int1_no_mot : 1;
-  uint8_t int1_fwm : 1;
-  uint8_t int1_ffull : 1;
-  uint8_t int1_data : 1;
-  uint8_t blank : 2;
-  uint8_t int1_q_tap : 1;
   uint8_t int1_any_mot : 1;
+  uint8_t int1_q_tap : 1;
+  uint8_t blank : 2;
+  uint8_t int1_data : 1;
+  uint8_t int1_ffull : 1;
+  uint8_t int1_fwm : 1;
+  uint8_t int1_no_mot : 1;
 } sfe_qma6100p_int_map1_t;
 
 typedef union
@@ -296,13 +350,13 @@ INT2_ANY_MOT: 1, map any motion interrupt to INT2 pin
 */
 typedef struct
 {
-  uint8_t int2_no_mot : 1;
-  uint8_t int2_fwm : 1;
-  uint8_t int2_ffull : 1;
-  uint8_t int2_data : 1;
-  uint8_t blank : 2;
-  uint8_t int2_q_tap : 1;
   uint8_t int2_any_mot : 1;
+  uint8_t int2_q_tap : 1;
+  uint8_t blank : 2;
+  uint8_t int2_data : 1;
+  uint8_t int2_ffull : 1;
+  uint8_t int2_fwm : 1;
+  uint8_t int2_no_mot : 1;
 } sfe_qma6100p_int_map3_t;
 
 typedef union
@@ -334,12 +388,32 @@ typedef union
 #define SFE_QMA6100P_REG_2B 0x2B
 
 #define SFE_QMA6100P_MOT_CONF0  0x2c
+/*
+ANY_MOT_DUR<1:0>: any motion interrupt will be triggered when slope > ANY_MOT_TH
+                  for (ANY_MOT_DUR<1:0> + 1) samples
+NO_MOT_DUR<5:0>: no motion interrupt will be triggered when slope < NO_MOT_TH for
+                 the duration defined by NO_MOT_DUR<5:0>
+*/
+typedef struct
+{
+  uint8_t any_mot_dur : 2;
+  uint8_t no_mot_dur : 6;
+} sfe_qma6100p_mot_conf0_t;
+
+typedef union
+{
+  uint8_t all;
+  sfe_qma6100p_mot_conf0_t bits;
+} sfe_qma6100p_mot_conf0_bitfield_t;
+
 #define SFE_QMA6100P_MOT_CONF1  0x2d
-#define SFE_QMA6100P_MOT_CONF2  0x2e
+#define SFE_QMA6100P_MOT_CONF2  0x2e  // ANY_MOT_TH<7:0>, threshold = ANY_MOT_TH * 16 LSB
 #define SFE_QMA6100P_MOT_CONF3  0x2f
 
 #define SFE_QMA6100P_REG_30 0x30
 #define SFE_QMA6100P_REG_31 0x31
+#define SFE_QMA6100P_FIFO_WM 0x31 // FIFO_WTMK_LVL<7:0>, watermark level in frames.
+                                  // Writing it clears the FIFO
 
 #define SFE_QMA6100P_ST 0x32
 
@@ -372,9 +446,9 @@ z-axis, ‘001b’ for x-axis only, ‘010b’ for y-axis only, ‘100b’ for z
 */
 typedef struct
 {
-  uint8_t fifo_mode : 2;
-  uint8_t raise_xyz_sw  : 3;
   uint8_t fifo_en_xyz : 3;
+  uint8_t raise_xyz_sw  : 3;
+  uint8_t fifo_mode : 2;
 } sfe_qma6100p_fifo_cfg0_t;
 
 typedef union
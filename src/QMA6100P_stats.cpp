@@ -0,0 +1,214 @@
+#include "QMA6100P_stats.h"
+#include <math.h>
+
+QMA6100P_Stats::QMA6100P_Stats()
+{
+  reset();
+}
+
+//////////////////////////////////////////////////
+// begin()
+//
+// Configures the window and clears all accumulators.
+//
+// Parameter:
+// blockLength - samples per block
+// numBlocks - blocks per window, 1 to SFE_QMA6100P_STATS_MAX_BLOCKS
+// mode - SFE_QMA6100P_STATS_TUMBLING or SFE_QMA6100P_STATS_SLIDING
+//
+bool QMA6100P_Stats::begin(uint16_t blockLength, uint8_t numBlocks, uint8_t mode)
+{
+  if (blockLength == 0 || numBlocks == 0 || numBlocks > SFE_QMA6100P_STATS_MAX_BLOCKS)
+    return false;
+
+  if (mode != SFE_QMA6100P_STATS_TUMBLING && mode != SFE_QMA6100P_STATS_SLIDING)
+    return false;
+
+  _blockLength = blockLength;
+  _numBlocks = numBlocks;
+  _mode = mode;
+
+  reset();
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setScale()
+//
+// Sets the conversion used at readout, e.g. convRange32G of the
+// sensor for the 32g range.
+//
+void QMA6100P_Stats::setScale(float gPerCount)
+{
+  _scale = gPerCount;
+}
+
+// drops all partial and completed blocks
+void QMA6100P_Stats::reset()
+{
+  clearBlock(_current);
+  _head = 0;
+  _filled = 0;
+  _windowCount = 0;
+  _available = false;
+}
+
+void QMA6100P_Stats::clearBlock(statsBlock &block)
+{
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    block.sum[i] = 0;
+    block.sumSq[i] = 0;
+    block.min[i] = INT16_MAX;
+    block.max[i] = INT16_MIN;
+  }
+  block.magSqMin = UINT32_MAX;
+  block.magSqMax = 0;
+  block.count = 0;
+}
+
+//////////////////////////////////////////////////
+// update()
+//
+// Accumulates a block of raw samples. Per sample this is a handful
+// of integer adds, multiplies and compares regardless of window size.
+//
+// Parameter:
+// *samples - raw samples, oldest first
+// count - number of samples
+//
+void QMA6100P_Stats::update(const rawOutputData *samples, int count)
+{
+  for (int n = 0; n < count; n++)
+  {
+    int16_t v[3] = {samples[n].xData, samples[n].yData, samples[n].zData};
+    uint32_t magSq = 0;
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      uint32_t sq = (uint32_t)((int32_t)v[i] * v[i]);
+
+      _current.sum[i] += v[i];
+      _current.sumSq[i] += sq;
+      magSq += sq;
+
+      if (v[i] < _current.min[i]) _current.min[i] = v[i];
+      if (v[i] > _current.max[i]) _current.max[i] = v[i];
+    }
+
+    if (magSq < _current.magSqMin) _current.magSqMin = magSq;
+    if (magSq > _current.magSqMax) _current.magSqMax = magSq;
+
+    if (++_current.count >= _blockLength)
+      completeBlock();
+  }
+}
+
+//////////////////////////////////////////////////
+// completeBlock()
+//
+// Moves the current block into the ring and, once a full window of
+// blocks is present, folds them into the window accumulators.
+//
+void QMA6100P_Stats::completeBlock()
+{
+  _blocks[_head] = _current;
+  _head = (_head + 1) % _numBlocks;
+  if (_filled < _numBlocks)
+    _filled++;
+
+  clearBlock(_current);
+
+  if (_filled < _numBlocks)
+    return;
+
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    _windowSum[i] = 0;
+    _windowSumSq[i] = 0;
+    _windowMin[i] = INT16_MAX;
+    _windowMax[i] = INT16_MIN;
+  }
+  _windowMagSqMin = UINT32_MAX;
+  _windowMagSqMax = 0;
+  _windowCount = 0;
+
+  for (uint8_t b = 0; b < _numBlocks; b++)
+  {
+    const statsBlock &block = _blocks[b];
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      _windowSum[i] += block.sum[i];
+      _windowSumSq[i] += block.sumSq[i];
+      if (block.min[i] < _windowMin[i]) _windowMin[i] = block.min[i];
+      if (block.max[i] > _windowMax[i]) _windowMax[i] = block.max[i];
+    }
+
+    if (block.magSqMin < _windowMagSqMin) _windowMagSqMin = block.magSqMin;
+    if (block.magSqMax > _windowMagSqMax) _windowMagSqMax = block.magSqMax;
+    _windowCount += block.count;
+  }
+
+  _available = true;
+
+  if (_mode == SFE_QMA6100P_STATS_TUMBLING)
+    _filled = 0;
+}
+
+// true when a window has completed since the last getStats()
+bool QMA6100P_Stats::available()
+{
+  return _available;
+}
+
+//////////////////////////////////////////////////
+// getStats()
+//
+// Converts the last completed window to g.
+//
+// Parameter:
+// *stats - receives the statistics
+//
+// Returns false if no window has completed yet.
+//
+bool QMA6100P_Stats::getStats(accelStats *stats)
+{
+  if (_windowCount == 0)
+    return false;
+
+  float n = (float)_windowCount;
+  axisStats *axes[3] = {&stats->x, &stats->y, &stats->z};
+  float magMeanSq = 0.0;
+
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    float meanSq = (float)_windowSumSq[i] / n;
+    int32_t peak = _windowMax[i];
+    if (-(int32_t)_windowMin[i] > peak)
+      peak = -(int32_t)_windowMin[i];
+
+    axes[i]->mean = (float)_windowSum[i] / n * _scale;
+    axes[i]->rms = sqrtf(meanSq) * _scale;
+    axes[i]->peak = (float)peak * _scale;
+    axes[i]->peakToPeak = (float)((int32_t)_windowMax[i] - _windowMin[i]) * _scale;
+    axes[i]->crestFactor = axes[i]->rms > 0 ? axes[i]->peak / axes[i]->rms : 0;
+
+    magMeanSq += meanSq;
+  }
+
+  float magMax = sqrtf((float)_windowMagSqMax);
+
+  stats->magnitude.mean = 0;
+  stats->magnitude.rms = sqrtf(magMeanSq) * _scale;
+  stats->magnitude.peak = magMax * _scale;
+  stats->magnitude.peakToPeak = (magMax - sqrtf((float)_windowMagSqMin)) * _scale;
+  stats->magnitude.crestFactor = stats->magnitude.rms > 0 ? stats->magnitude.peak / stats->magnitude.rms : 0;
+
+  stats->samples = _windowCount;
+
+  _available = false;
+
+  return true;
+}
@@ -0,0 +1,89 @@
+// The following class implements streaming window statistics on raw samples of
+// any SFE_AccelCore part (QMA6100P, KX134).
+// Mean, RMS, peak, peak-to-peak and crest factor are kept per axis and for the
+// vector magnitude |a| with a constant cost per sample. Accumulation is done on
+// raw counts in integers; the conversion to g only happens when the statistics
+// are read out.
+//
+// A window is made of numBlocks blocks of blockLength samples. Only one set of
+// accumulators per block is stored, never the samples themselves. In tumbling
+// mode a result is produced every window and the window restarts; in sliding
+// mode a result is produced every block over the last numBlocks blocks.
+
+#pragma once
+
+#include "SFE_AccelCore.h"
+
+#define SFE_QMA6100P_STATS_TUMBLING 0
+#define SFE_QMA6100P_STATS_SLIDING  1
+
+#define SFE_QMA6100P_STATS_MAX_BLOCKS 8
+
+struct axisStats
+{
+  float mean;
+  float rms;
+  float peak;        // largest absolute value
+  float peakToPeak;
+  float crestFactor; // peak / rms
+};
+
+struct accelStats
+{
+  axisStats x;
+  axisStats y;
+  axisStats z;
+  axisStats magnitude; // |a|, mean is not tracked and reads 0
+  uint32_t samples;
+};
+
+// Integer accumulators for one block, in raw counts
+struct statsBlock
+{
+  int32_t sum[3];
+  uint64_t sumSq[3];
+  int16_t min[3];
+  int16_t max[3];
+  uint32_t magSqMin;
+  uint32_t magSqMax;
+  uint16_t count;
+};
+
+class QMA6100P_Stats
+{
+public:
+  QMA6100P_Stats();
+
+  bool begin(uint16_t blockLength, uint8_t numBlocks = 1, uint8_t mode = SFE_QMA6100P_STATS_TUMBLING);
+  void setScale(float gPerCount);
+  void reset();
+
+  void update(const rawOutputData *samples, int count);
+  bool available();
+  bool getStats(accelStats *stats);
+
+protected:
+  static void clearBlock(statsBlock &block);
+  void completeBlock();
+
+  statsBlock _blocks[SFE_QMA6100P_STATS_MAX_BLOCKS];
+  statsBlock _current;
+
+  // Combined accumulators of the last completed window
+  int64_t _windowSum[3];
+  uint64_t _windowSumSq[3];
+  int16_t _windowMin[3];
+  int16_t _windowMax[3];
+  uint32_t _windowMagSqMin = 0;
+  uint32_t _windowMagSqMax = 0;
+  uint32_t _windowCount = 0;
+
+  uint16_t _blockLength = 1;
+  uint8_t _numBlocks = 1;
+  uint8_t _mode = SFE_QMA6100P_STATS_TUMBLING;
+  uint8_t _head = 0;   // next block slot to write
+  uint8_t _filled = 0; // completed blocks in the ring
+  bool _available = false;
+
+  float _scale = 0.000244; // g per count, default QMA6100P 2g range
+};
@@ -0,0 +1,275 @@
+#include "QMA6100P_stream.h"
+
+#if defined(SFE_ACCEL_HOST_THREADS)
+#include <chrono>
+#endif
+
+// _head, _reserve and _running are shared between the producer and the consumers
+#define SFE_STREAM_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define SFE_STREAM_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#define SFE_STREAM_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+QMA6100P_Stream::QMA6100P_Stream(QMA6100P &sensor) : _sensor(sensor)
+{
+}
+
+//////////////////////////////////////////////////
+// begin()
+//
+// Hands the ring to the stream. Consumers attached afterwards start
+// with the next sample produced.
+//
+// Parameter:
+// *buffer - caller-provided storage for size samples
+// size - ring length, a power of two of at least 64 (one full FIFO)
+//
+bool QMA6100P_Stream::begin(rawOutputData *buffer, uint16_t size)
+{
+  if (buffer == nullptr || size < 64 || (size & (size - 1)) != 0)
+    return false;
+
+  _buffer = buffer;
+  _size = size;
+  _mask = size - 1;
+  _head = 0;
+  _reserve = 0;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// service()
+//
+// Producer side: drains the FIFO into the ring. Only one task may
+// call it; with start() that is the acquisition task.
+//
+// Returns the number of samples added, or -1 on a bus error.
+//
+int QMA6100P_Stream::service()
+{
+  if (_buffer == nullptr)
+    return -1;
+
+  uint16_t frames;
+  if (!_sensor.getFifoLevel(&frames))
+    return -1;
+
+  int total = 0;
+
+  while (frames > 0)
+  {
+    uint16_t index = _head & _mask;
+    uint16_t n = _size - index; // contiguous space up to the end of the ring
+    if (n > frames)
+      n = frames;
+
+    // Announce the slots about to be overwritten before touching them. After
+    // a failed read _reserve is already past _head and must not move back.
+    if ((int32_t)(_head + n - _reserve) > 0)
+      SFE_STREAM_STORE(_reserve, _head + n);
+    SFE_STREAM_FENCE();
+
+    int count = _sensor.readFifoFrames(&_buffer[index], n);
+    if (count < 0)
+      return -1;
+
+    SFE_STREAM_STORE(_head, _head + count);
+
+    total += count;
+
+    if (count < n) // a short read cut the drain
+      break;
+
+    frames -= n;
+  }
+
+  return total;
+}
+
+// sequence number of the next sample to be produced
+uint32_t QMA6100P_Stream::getSequence()
+{
+  return SFE_STREAM_LOAD(_head);
+}
+
+//////////////////////////////////////////////////
+// attach()
+//
+// Starts a consumer at the next sample produced. The reader is owned
+// by the consumer and is not registered anywhere, so attaching and
+// dropping consumers costs the producer nothing.
+//
+void QMA6100P_Stream::attach(streamReader *reader)
+{
+  reader->cursor = SFE_STREAM_LOAD(_head);
+  reader->dropped = 0;
+}
+
+// moves a reader that fell a ring behind to the oldest valid sample
+uint32_t QMA6100P_Stream::catchUp(streamReader *reader)
+{
+  uint32_t oldest = SFE_STREAM_LOAD(_reserve) - _size;
+
+  if ((int32_t)(oldest - reader->cursor) > 0)
+  {
+    reader->dropped += oldest - reader->cursor;
+    reader->cursor = oldest;
+  }
+
+  return SFE_STREAM_LOAD(_head);
+}
+
+// samples waiting for this reader
+uint16_t QMA6100P_Stream::available(streamReader *reader)
+{
+  uint32_t head = catchUp(reader);
+
+  return (uint16_t)(head - reader->cursor);
+}
+
+//////////////////////////////////////////////////
+// peek()
+//
+// Consumer side: points *samples at the reader's next samples in the
+// ring, without copying. Samples that wrap around the end of the ring
+// come back on the next peek().
+//
+// Returns the number of contiguous samples available.
+//
+uint16_t QMA6100P_Stream::peek(streamReader *reader, const rawOutputData **samples)
+{
+  uint32_t head = catchUp(reader);
+  uint16_t index = reader->cursor & _mask;
+  uint16_t count = (uint16_t)(head - reader->cursor);
+
+  if (count > _size - index)
+    count = _size - index;
+
+  *samples = &_buffer[index];
+
+  return count;
+}
+
+//////////////////////////////////////////////////
+// release()
+//
+// Consumer side: marks count peeked samples as read.
+//
+// Returns false if the producer overwrote any of them while they were
+// being read; they are counted as dropped and the reader skips ahead.
+//
+bool QMA6100P_Stream::release(streamReader *reader, uint16_t count)
+{
+  SFE_STREAM_FENCE();
+
+  uint32_t oldest = SFE_STREAM_LOAD(_reserve) - _size;
+
+  if ((int32_t)(oldest - reader->cursor) > 0)
+  {
+    catchUp(reader);
+    return false;
+  }
+
+  reader->cursor += count;
+
+  return true;
+}
+
+#if defined(SFE_ACCEL_HOST_THREADS)
+
+// a running std::thread must be joined before it is destroyed
+QMA6100P_Stream::~QMA6100P_Stream()
+{
+  stop();
+}
+
+//////////////////////////////////////////////////
+// start()
+//
+// Runs service() every periodMs on its own thread. Keep the period
+// under the time the FIFO takes to fill (64 samples).
+//
+bool QMA6100P_Stream::start(uint32_t periodMs)
+{
+  if (_buffer == nullptr || SFE_STREAM_LOAD(_running))
+    return false;
+
+  _periodMs = periodMs;
+  SFE_STREAM_STORE(_running, true);
+
+  _thread = std::thread([this]() {
+    while (SFE_STREAM_LOAD(_running))
+    {
+      service();
+      std::this_thread::sleep_for(std::chrono::milliseconds(_periodMs));
+    }
+  });
+
+  return true;
+}
+
+void QMA6100P_Stream::stop()
+{
+  SFE_STREAM_STORE(_running, false);
+
+  if (_thread.joinable())
+    _thread.join();
+}
+
+#elif defined(SFE_ACCEL_FREERTOS)
+
+void QMA6100P_Stream::task(void *stream)
+{
+  QMA6100P_Stream *self = static_cast<QMA6100P_Stream *>(stream);
+  TickType_t wake = xTaskGetTickCount();
+  TickType_t period = pdMS_TO_TICKS(self->_periodMs) > 0 ? pdMS_TO_TICKS(self->_periodMs) : 1;
+
+  while (SFE_STREAM_LOAD(self->_running))
+  {
+    self->service();
+    vTaskDelayUntil(&wake, period);
+  }
+
+  SFE_STREAM_STORE(self->_task, nullptr);
+  vTaskDelete(nullptr);
+}
+
+// waits for the task to finish its pass so it never touches a dead stream
+QMA6100P_Stream::~QMA6100P_Stream()
+{
+  stop();
+
+  while (SFE_STREAM_LOAD(_task) != nullptr)
+    vTaskDelay(1);
+}
+
+//////////////////////////////////////////////////
+// start()
+//
+// Starts the acquisition task, which runs service() every periodMs.
+// Keep the period under the time the FIFO takes to fill (64 samples).
+//
+bool QMA6100P_Stream::start(uint32_t periodMs)
+{
+  if (_buffer == nullptr || SFE_STREAM_LOAD(_running) || _task != nullptr)
+    return false;
+
+  _periodMs = periodMs;
+  SFE_STREAM_STORE(_running, true);
+
+  if (xTaskCreate(task, "qma6100p", 2048, this, configMAX_PRIORITIES - 2, &_task) != pdPASS)
+  {
+    SFE_STREAM_STORE(_running, false);
+    return false;
+  }
+
+  return true;
+}
+
+// the task finishes its current pass and deletes itself
+void QMA6100P_Stream::stop()
+{
+  SFE_STREAM_STORE(_running, false);
+}
+
+#endif
@@ -0,0 +1,83 @@
+// The following class fans QMA6100P samples out to any number of consumers.
+// One producer drains the FIFO straight into a shared ring; each consumer
+// keeps its own cursor in a streamReader and reads the samples in place, so
+// a sample is never copied per consumer and consumers never wait on each
+// other or on the bus.
+//
+// The producer never waits for a slow consumer either. A consumer that falls
+// more than a ring behind skips ahead and counts the samples it lost, and
+// release() reports when samples were overwritten while being read.
+//
+// That overwrite is a real data race on the slot contents: peek() hands out
+// plain pointers so samples are never copied, and the producer may store
+// into a slot while a consumer reads it. Treat what was read as valid only
+// once release() returns true, and discard it otherwise. Race detectors
+// report it; extras/host_test/tsan.supp scopes the suppression to it.
+//
+// The producer is service(), called from loop(), or the acquisition task
+// started by start() on FreeRTOS (SFE_ACCEL_FREERTOS) and host
+// (SFE_ACCEL_HOST_THREADS) builds. Set a bus lock on the sensor when other
+// tasks use the same bus.
+
+#pragma once
+
+#include "QMA6100P.h"
+
+#if defined(SFE_ACCEL_HOST_THREADS)
+#include <thread>
+#elif defined(SFE_ACCEL_FREERTOS) && defined(ARDUINO_ARCH_ESP32)
+#include <freertos/task.h>
+#elif defined(SFE_ACCEL_FREERTOS)
+#include <task.h>
+#endif
+
+struct streamReader
+{
+  uint32_t cursor;  // sequence number of the next sample to read
+  uint32_t dropped; // samples overwritten before they were read
+};
+
+class QMA6100P_Stream
+{
+public:
+  QMA6100P_Stream(QMA6100P &sensor);
+
+  bool begin(rawOutputData *buffer, uint16_t size);
+  int service();
+
+#if defined(SFE_ACCEL_FREERTOS) || defined(SFE_ACCEL_HOST_THREADS)
+  ~QMA6100P_Stream();
+
+  bool start(uint32_t periodMs);
+  void stop();
+#endif
+
+  void attach(streamReader *reader);
+  uint16_t available(streamReader *reader);
+  uint16_t peek(streamReader *reader, const rawOutputData **samples);
+  bool release(streamReader *reader, uint16_t count);
+
+  uint32_t getSequence();
+
+protected:
+  uint32_t catchUp(streamReader *reader);
+
+  QMA6100P &_sensor;
+
+  rawOutputData *_buffer = nullptr;
+  uint16_t _size = 0; // power of two
+  uint16_t _mask = 0;
+
+  uint32_t _head = 0;    // samples published
+  uint32_t _reserve = 0; // samples published or being written
+
+  bool _running = false;
+  uint32_t _periodMs = 0;
+
+#if defined(SFE_ACCEL_HOST_THREADS)
+  std::thread _thread;
+#elif defined(SFE_ACCEL_FREERTOS)
+  static void task(void *stream);
+  TaskHandle_t _task = nullptr;
+#endif
+};
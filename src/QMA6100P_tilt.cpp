@@ -0,0 +1,263 @@
+#include "QMA6100P_tilt.h"
+
+#define SFE_QMA6100P_CORDIC_ITERATIONS 16
+
+// atan(2^-i) in units of 1/6400 degree, so results round to 0.01 degree with a shift
+static const int32_t cordicAtanTable[SFE_QMA6100P_CORDIC_ITERATIONS] = {
+  288000, 170016, 89832, 45600, 22889, 11455, 5729, 2865,
+  1432, 716, 358, 179, 90, 45, 22, 11
+};
+
+#define SFE_QMA6100P_CORDIC_180DEG 1152000L // 180 degrees in table units
+#define SFE_QMA6100P_CORDIC_GAIN_INV 39797UL // 1 / 1.646760 in Q16
+#define SFE_QMA6100P_CORDIC_SHIFT 14 // raw 16 bit inputs keep 2 bits headroom for CORDIC growth
+
+//////////////////////////////////////////////////
+// cordicVector()
+//
+// Rotates (x, y) onto the positive x axis. Returns the angle of the
+// input vector in 1/6400 degree and leaves the CORDIC-scaled
+// magnitude (1.646760 * |v|) in x. Inputs must stay below 2^29.
+//
+int32_t QMA6100P_Tilt::cordicVector(int32_t &x, int32_t &y)
+{
+  int32_t angle = 0;
+
+  // Bring the vector into the right half plane where CORDIC converges
+  if (x < 0)
+  {
+    angle = (y >= 0) ? SFE_QMA6100P_CORDIC_180DEG : -SFE_QMA6100P_CORDIC_180DEG;
+    x = -x;
+    y = -y;
+  }
+
+  for (uint8_t i = 0; i < SFE_QMA6100P_CORDIC_ITERATIONS; i++)
+  {
+    int32_t dx = x >> i;
+    int32_t dy = y >> i;
+
+    if (y > 0)
+    {
+      x += dy;
+      y -= dx;
+      angle += cordicAtanTable[i];
+    }
+    else
+    {
+      x -= dy;
+      y += dx;
+      angle -= cordicAtanTable[i];
+    }
+  }
+
+  return angle;
+}
+
+//////////////////////////////////////////////////
+// fastAtan2()
+//
+// Integer replacement for atan2(y, x).
+//
+// Returns the angle in 0.01 degree, -18000 to 18000.
+//
+int16_t QMA6100P_Tilt::fastAtan2(int32_t y, int32_t x)
+{
+  if (x == 0 && y == 0)
+    return 0;
+
+  // Normalise so the larger component sits just below 2^29
+  uint32_t m = (x < 0 ? 0UL - (uint32_t)x : (uint32_t)x) | (y < 0 ? 0UL - (uint32_t)y : (uint32_t)y);
+  while (m >= (1UL << 29))
+  {
+    x >>= 1;
+    y >>= 1;
+    m >>= 1;
+  }
+  while (m < (1UL << 28))
+  {
+    x *= 2;
+    y *= 2;
+    m <<= 1;
+  }
+
+  return (int16_t)((cordicVector(x, y) + 32) >> 6);
+}
+
+//////////////////////////////////////////////////
+// getTilt()
+//
+// Computes pitch and roll from one raw sample.
+//
+// roll = atan2(y, z)
+// pitch = atan2(-x, sqrt(y^2 + z^2))
+//
+// The magnitude for the pitch comes out of the roll CORDIC, so
+// no square root is taken.
+//
+// Parameter:
+// *rawAccelData - raw sample, any range
+// *tilt - receives pitch and roll in 0.01 degree
+//
+void QMA6100P_Tilt::getTilt(const rawOutputData *rawAccelData, tiltData *tilt)
+{
+  int32_t x = (int32_t)rawAccelData->xData * (1L << SFE_QMA6100P_CORDIC_SHIFT);
+  int32_t y = (int32_t)rawAccelData->yData * (1L << SFE_QMA6100P_CORDIC_SHIFT);
+  int32_t z = (int32_t)rawAccelData->zData * (1L << SFE_QMA6100P_CORDIC_SHIFT);
+
+  if (y == 0 && z == 0)
+  {
+    tilt->roll = 0;
+    tilt->pitch = (x > 0) ? -9000 : (x < 0 ? 9000 : 0);
+    return;
+  }
+
+  int32_t roll = cordicVector(z, y);
+
+  // Remove the CORDIC gain, split so the products fit in 32 bits
+  uint32_t mag = (uint32_t)z;
+  uint32_t r = (mag >> 16) * SFE_QMA6100P_CORDIC_GAIN_INV + (((mag & 0xFFFF) * SFE_QMA6100P_CORDIC_GAIN_INV) >> 16);
+
+  int32_t px = (int32_t)r;
+  int32_t py = -x;
+  int32_t pitch = cordicVector(px, py);
+
+  tilt->roll = (int16_t)((roll + 32) >> 6);
+  tilt->pitch = (int16_t)((pitch + 32) >> 6);
+}
+
+//////////////////////////////////////////////////
+// getTilt()
+//
+// Batch version for FIFO blocks.
+//
+// Parameter:
+// *rawAccelData - array of raw samples
+// *tilt - array receiving one result per sample
+// count - number of samples
+//
+void QMA6100P_Tilt::getTilt(const rawOutputData *rawAccelData, tiltData *tilt, int count)
+{
+  for (int i = 0; i < count; i++)
+    getTilt(&rawAccelData[i], &tilt[i]);
+}
+
+//////////////////////////////////////////////////
+// classify()
+//
+// Returns the orientation whose axis carries the largest share of
+// gravity, and that axis' magnitude in raw counts.
+//
+uint8_t QMA6100P_Tilt::classify(const rawOutputData *rawAccelData, int32_t *magnitude)
+{
+  int32_t ax = rawAccelData->xData < 0 ? -(int32_t)rawAccelData->xData : rawAccelData->xData;
+  int32_t ay = rawAccelData->yData < 0 ? -(int32_t)rawAccelData->yData : rawAccelData->yData;
+  int32_t az = rawAccelData->zData < 0 ? -(int32_t)rawAccelData->zData : rawAccelData->zData;
+
+  if (ax >= ay && ax >= az)
+  {
+    *magnitude = ax;
+    return rawAccelData->xData >= 0 ? SFE_QMA6100P_ORIENT_X_UP : SFE_QMA6100P_ORIENT_X_DOWN;
+  }
+
+  if (ay >= az)
+  {
+    *magnitude = ay;
+    return rawAccelData->yData >= 0 ? SFE_QMA6100P_ORIENT_Y_UP : SFE_QMA6100P_ORIENT_Y_DOWN;
+  }
+
+  *magnitude = az;
+  return rawAccelData->zData >= 0 ? SFE_QMA6100P_ORIENT_Z_UP : SFE_QMA6100P_ORIENT_Z_DOWN;
+}
+
+// signed component of the sample along the "up" direction of an orientation
+int32_t QMA6100P_Tilt::axisMagnitude(const rawOutputData *rawAccelData, uint8_t orientation)
+{
+  switch (orientation)
+  {
+  case SFE_QMA6100P_ORIENT_X_UP:
+    return rawAccelData->xData;
+  case SFE_QMA6100P_ORIENT_X_DOWN:
+    return -(int32_t)rawAccelData->xData;
+  case SFE_QMA6100P_ORIENT_Y_UP:
+    return rawAccelData->yData;
+  case SFE_QMA6100P_ORIENT_Y_DOWN:
+    return -(int32_t)rawAccelData->yData;
+  case SFE_QMA6100P_ORIENT_Z_UP:
+    return rawAccelData->zData;
+  case SFE_QMA6100P_ORIENT_Z_DOWN:
+    return -(int32_t)rawAccelData->zData;
+  default:
+    return 0;
+  }
+}
+
+//////////////////////////////////////////////////
+// updateOrientation()
+//
+// Feeds samples to the orientation tracker. A new orientation is
+// only accepted when its axis exceeds the current one by the
+// hysteresis margin for the debounce count of consecutive samples,
+// so the result does not chatter around 45 degrees.
+//
+// Parameter:
+// *rawAccelData - array of raw samples, oldest first
+// count - number of samples
+//
+// Returns the orientation after the last sample.
+//
+uint8_t QMA6100P_Tilt::updateOrientation(const rawOutputData *rawAccelData, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    int32_t candidateMag;
+    uint8_t candidate = classify(&rawAccelData[i], &candidateMag);
+
+    if (candidate == _orientation)
+    {
+      _candidateCount = 0;
+      continue;
+    }
+
+    if (_orientation != SFE_QMA6100P_ORIENT_UNKNOWN)
+    {
+      int32_t current = axisMagnitude(&rawAccelData[i], _orientation);
+
+      if (candidateMag * 100 <= current * (100 + _hysteresis))
+      {
+        _candidateCount = 0;
+        continue;
+      }
+    }
+
+    if (candidate != _candidate)
+    {
+      _candidate = candidate;
+      _candidateCount = 0;
+    }
+
+    if (++_candidateCount >= _debounce)
+    {
+      _orientation = candidate;
+      _candidateCount = 0;
+    }
+  }
+
+  return _orientation;
+}
+
+uint8_t QMA6100P_Tilt::getOrientation()
+{
+  return _orientation;
+}
+
+// margin, in percent, the new axis must exceed the current one by
+void QMA6100P_Tilt::setHysteresis(uint8_t percent)
+{
+  _hysteresis = percent;
+}
+
+// consecutive samples a new orientation must hold before it is reported
+void QMA6100P_Tilt::setDebounce(uint8_t samples)
+{
+  _debounce = samples > 0 ? samples : 1;
+}
@@ -0,0 +1,53 @@
+// The following class implements integer tilt and orientation from raw samples of
+// any SFE_AccelCore part (QMA6100P, KX134).
+// Pitch and roll are computed from raw counts with a shift-and-add CORDIC so no
+// floating point or libm trigonometry is needed, which matters on MCUs without
+// an FPU. Results are in hundredths of a degree.
+//
+// Error bound: against double precision atan2() the angles are within
+// +/- 0.02 degrees for any input in the 14 bit output range (16 CORDIC
+// iterations, 1e-4 degree arctangent table, final rounding to 0.01 degree).
+// Sensor noise dominates long before this does.
+
+#pragma once
+
+#include "SFE_AccelCore.h"
+
+// Six-way orientation - which side of the board faces up
+#define SFE_QMA6100P_ORIENT_UNKNOWN 0
+#define SFE_QMA6100P_ORIENT_X_UP    1
+#define SFE_QMA6100P_ORIENT_X_DOWN  2
+#define SFE_QMA6100P_ORIENT_Y_UP    3
+#define SFE_QMA6100P_ORIENT_Y_DOWN  4
+#define SFE_QMA6100P_ORIENT_Z_UP    5
+#define SFE_QMA6100P_ORIENT_Z_DOWN  6
+
+struct tiltData
+{
+  int16_t pitch; // 0.01 degree, -9000 to 9000
+  int16_t roll;  // 0.01 degree, -18000 to 18000
+};
+
+class QMA6100P_Tilt
+{
+public:
+  static int16_t fastAtan2(int32_t y, int32_t x);
+  static void getTilt(const rawOutputData *rawAccelData, tiltData *tilt);
+  static void getTilt(const rawOutputData *rawAccelData, tiltData *tilt, int count);
+
+  uint8_t updateOrientation(const rawOutputData *rawAccelData, int count = 1);
+  uint8_t getOrientation();
+  void setHysteresis(uint8_t percent);
+  void setDebounce(uint8_t samples);
+
+protected:
+  static int32_t cordicVector(int32_t &x, int32_t &y);
+  static uint8_t classify(const rawOutputData *rawAccelData, int32_t *magnitude);
+  static int32_t axisMagnitude(const rawOutputData *rawAccelData, uint8_t orientation);
+
+  uint8_t _orientation = SFE_QMA6100P_ORIENT_UNKNOWN;
+  uint8_t _candidate = SFE_QMA6100P_ORIENT_UNKNOWN;
+  uint8_t _candidateCount = 0;
+  uint8_t _hysteresis = 20; // percent the new axis must exceed the current one by
+  uint8_t _debounce = 4;    // consecutive samples before the orientation changes
+};
@@ -0,0 +1,228 @@
+#include "QMA6100P_velocity.h"
+#include <math.h>
+
+#define SFE_VELOCITY_COEF_ONE ((int64_t)1 << SFE_VELOCITY_COEF_SHIFT)
+
+// float coefficient to fixed point, 0 if it does not fit
+static int32_t toCoef(double value)
+{
+  double coef = value * (double)SFE_VELOCITY_COEF_ONE + 0.5;
+
+  if (coef < 0.0 || coef > 2147483647.0)
+    return 0;
+
+  return (int32_t)coef;
+}
+
+QMA6100P_Velocity::QMA6100P_Velocity()
+{
+  for (uint8_t i = 0; i < 3; i++)
+    _bias[i] = 0;
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+// begin()
+//
+// Works out the filter coefficients for the data rate and range.
+//
+// Parameter:
+// samplePeriod - time between samples in microseconds, e.g. from
+//                QMA6100P::getSamplePeriod()
+// gPerCount - conversion of the range in use, e.g. convRange8G
+// cutoffHz - high-pass corner of the integrators, below the Nyquist rate
+//
+bool QMA6100P_Velocity::begin(uint32_t samplePeriod, float gPerCount, float cutoffHz)
+{
+  if (samplePeriod == 0 || gPerCount <= 0.0 || cutoffHz <= 0.0)
+    return false;
+
+  double dt = samplePeriod / 1000000.0;
+
+  if (cutoffHz * dt >= 0.5)
+    return false;
+
+  // counts << 14 to um/s << 4 per sample
+  double gain = gPerCount * SENSORS_GRAVITY_EARTH * 1000000.0 * dt * (1 << SFE_VELOCITY_STATE_SHIFT) / (1L << SFE_VELOCITY_ACCEL_SHIFT);
+
+  _gain = toCoef(gain);
+  _leak = toCoef(1.0 - exp(-2.0 * M_PI * cutoffHz * dt)); // exact first order pole
+  _dt = toCoef(dt);
+
+  if (_gain == 0 || _leak == 0 || _dt == 0)
+    return false;
+
+  _gPerCount = gPerCount;
+  _samplePeriod = samplePeriod;
+
+  setBiasTimeConstant(1.0);
+  setWindow(1000000UL / samplePeriod); // 1 s
+
+  reset();
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+// setBiasTimeConstant()
+//
+// Sets how quickly the bias follows the input. It has to be well
+// below the cutoff (1 s against 10 Hz by default). 0 freezes the bias
+// at the value given to setBias() / useOffsets().
+//
+void QMA6100P_Velocity::setBiasTimeConstant(float seconds)
+{
+  if (seconds <= 0.0 || _samplePeriod == 0)
+  {
+    _biasCoef = 0;
+    return;
+  }
+
+  _biasCoef = toCoef(1.0 - exp(-(_samplePeriod / 1000000.0) / seconds));
+}
+
+//////////////////////////////////////////////////
+// setBias()
+//
+// Sets the bias of each axis in g. useOffsets() calls this with the
+// sensor offsets.
+//
+void QMA6100P_Velocity::setBias(float x, float y, float z)
+{
+  const float g[] = {x, y, z};
+
+  for (uint8_t i = 0; i < 3; i++)
+    _bias[i] = (int64_t)((double)g[i] / _gPerCount * (1L << SFE_VELOCITY_ACCEL_SHIFT)) * SFE_VELOCITY_COEF_ONE;
+}
+
+// samples per RMS window
+void QMA6100P_Velocity::setWindow(uint32_t samples)
+{
+  _window = samples > 0 ? samples : 1;
+  _count = 0;
+  for (uint8_t i = 0; i < 3; i++)
+    _sumSq[i] = 0;
+}
+
+// clears velocity, displacement and the RMS window, keeps the bias
+void QMA6100P_Velocity::reset()
+{
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    _velocity[i] = 0;
+    _displacement[i] = 0;
+    _sumSq[i] = 0;
+    _lastSumSq[i] = 0;
+  }
+
+  _count = 0;
+  _lastCount = 0;
+  _rmsValid = false;
+  _available = false;
+}
+
+// value * coef >> SFE_VELOCITY_COEF_SHIFT, rounded
+int32_t QMA6100P_Velocity::mulCoef(int32_t value, int32_t coef)
+{
+  return (int32_t)(((int64_t)value * coef + (SFE_VELOCITY_COEF_ONE >> 1)) >> SFE_VELOCITY_COEF_SHIFT);
+}
+
+//////////////////////////////////////////////////
+// update()
+//
+// Integrates a block of raw samples. Per sample and axis this is one
+// 64 bit bias update and four fixed point multiplies; a completed
+// window is only snapshotted, getVelocityRMS() takes the square root.
+//
+// Parameter:
+// *samples - raw samples, oldest first, in the range given to begin()
+// count - number of samples
+//
+void QMA6100P_Velocity::update(const rawOutputData *samples, int count)
+{
+  for (int n = 0; n < count; n++)
+  {
+    const int16_t raw[] = {samples[n].xData, samples[n].yData, samples[n].zData};
+
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      int32_t accel = (int32_t)raw[i] * (1L << SFE_VELOCITY_ACCEL_SHIFT);
+      int32_t corrected = accel - (int32_t)(_bias[i] >> SFE_VELOCITY_COEF_SHIFT);
+
+      _bias[i] += (int64_t)corrected * _biasCoef;
+
+      // Leak first so the new increment is not attenuated
+      int32_t v = _velocity[i];
+      v += mulCoef(corrected, _gain) - mulCoef(v, _leak);
+      _velocity[i] = v;
+
+      int32_t d = _displacement[i];
+      d += mulCoef(v, _dt) - mulCoef(d, _leak);
+      _displacement[i] = d;
+
+      int32_t um = v / (1 << SFE_VELOCITY_STATE_SHIFT);
+      _sumSq[i] += (uint64_t)((int64_t)um * um);
+    }
+
+    if (++_count >= _window)
+    {
+      for (uint8_t i = 0; i < 3; i++)
+      {
+        _lastSumSq[i] = _sumSq[i];
+        _sumSq[i] = 0;
+      }
+
+      _lastCount = _count;
+      _count = 0;
+      _rmsValid = true;
+      _available = true;
+    }
+  }
+}
+
+// true when a window has completed since the last getVelocityRMS()
+bool QMA6100P_Velocity::available()
+{
+  return _available;
+}
+
+//////////////////////////////////////////////////
+// getVelocityRMS()
+//
+// Returns the velocity RMS of each axis over the last completed
+// window in mm/s, or false if no window has completed yet.
+//
+bool QMA6100P_Velocity::getVelocityRMS(outputData *rms)
+{
+  if (!_rmsValid)
+    return false;
+
+  rms->xData = sqrt((double)_lastSumSq[0] / _lastCount) / 1000.0; // mm/s
+  rms->yData = sqrt((double)_lastSumSq[1] / _lastCount) / 1000.0;
+  rms->zData = sqrt((double)_lastSumSq[2] / _lastCount) / 1000.0;
+
+  _available = false;
+
+  return true;
+}
+
+// current velocity in mm/s
+void QMA6100P_Velocity::getVelocity(outputData *velocity)
+{
+  const float scale = 1.0 / (1000.0 * (1 << SFE_VELOCITY_STATE_SHIFT));
+
+  velocity->xData = _velocity[0] * scale;
+  velocity->yData = _velocity[1] * scale;
+  velocity->zData = _velocity[2] * scale;
+}
+
+// current displacement in um
+void QMA6100P_Velocity::getDisplacement(outputData *displacement)
+{
+  const float scale = 1.0 / (1 << SFE_VELOCITY_STATE_SHIFT);
+
+  displacement->xData = _displacement[0] * scale;
+  displacement->yData = _displacement[1] * scale;
+  displacement->zData = _displacement[2] * scale;
+}
@@ -0,0 +1,77 @@
+// The following class integrates raw acceleration of any SFE_AccelCore part
+// (QMA6100P, KX134) to vibration velocity and displacement, and reports the
+// velocity RMS in mm/s over fixed windows as used by ISO 10816.
+//
+// All per-sample work is fixed point. Each axis first has its bias removed: the
+// bias starts from the sensor offsets (calibrateOffsets() or setOffset()) and
+// is then tracked with a slow low-pass so gravity and offset drift do not leak
+// into the integral. Velocity and displacement come from leaky integrators
+// whose leak is a first order high-pass at the cutoff frequency (10 Hz by
+// default, the lower edge of the ISO 10816 band), so neither can drift away.
+// Integration is per sample, so keep the sample rate well above the highest
+// frequency of interest (about 6x for 5% error).
+//
+// Call begin() before setBias() / useOffsets(): the bias is kept in counts of
+// the range given to begin().
+
+#pragma once
+
+#include "SFE_AccelCore.h"
+
+// Fixed point formats
+#define SFE_VELOCITY_ACCEL_SHIFT 14 // corrected acceleration, counts << 14 (16 bit parts fit)
+#define SFE_VELOCITY_COEF_SHIFT  24 // filter coefficients; bias is counts << (14 + 24)
+#define SFE_VELOCITY_STATE_SHIFT 4  // velocity in um/s << 4, displacement in um << 4
+
+class QMA6100P_Velocity
+{
+public:
+  QMA6100P_Velocity();
+
+  bool begin(uint32_t samplePeriod, float gPerCount, float cutoffHz = 10.0);
+  void setBiasTimeConstant(float seconds);
+  void setBias(float x, float y, float z);
+  void setWindow(uint32_t samples);
+  void reset();
+
+  // Seeds the bias from the sensor offsets. calibrateOffsets() assumes
+  // z is aligned with gravity, so 1g is added back on that axis.
+  template <class Backend>
+  void useOffsets(SFE_AccelCore<Backend> &sensor, bool gravityOnZ = true)
+  {
+    float x, y, z;
+    sensor.getOffset(x, y, z);
+    setBias(x, y, z + (gravityOnZ ? 1.0 : 0.0));
+  }
+
+  void update(const rawOutputData *samples, int count);
+  bool available();
+  bool getVelocityRMS(outputData *rms);
+  void getVelocity(outputData *velocity);
+  void getDisplacement(outputData *displacement);
+
+protected:
+  static int32_t mulCoef(int32_t value, int32_t coef);
+
+  float _gPerCount = 0.000244; // default QMA6100P 2g range
+  uint32_t _samplePeriod = 0;  // microseconds
+
+  // Filter coefficients, << SFE_VELOCITY_COEF_SHIFT
+  int32_t _biasCoef = 0; // bias low-pass, 0 holds the bias
+  int32_t _gain = 0;     // corrected acceleration to velocity increment
+  int32_t _leak = 0;     // integrator leak per sample
+  int32_t _dt = 0;       // sample period in seconds
+
+  int64_t _bias[3];
+  int32_t _velocity[3];
+  int32_t _displacement[3];
+
+  // RMS window, in um/s
+  uint64_t _sumSq[3];
+  uint32_t _count = 0;
+  uint32_t _window = 1;
+  uint64_t _lastSumSq[3]; // last completed window, converted by getVelocityRMS()
+  uint32_t _lastCount = 0;
+  bool _rmsValid = false; // a window has completed since reset()
+  bool _available = false;
+};
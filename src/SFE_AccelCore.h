@@ -0,0 +1,808 @@
+// The following class template holds the parts of the accelerometer data path
+// that do not depend on the part: I2C register access, conversion to g, offset
+// handling, FIFO draining and bus instrumentation. Each chip derives from it and
+// supplies a handful of hooks; the calls are resolved at compile time (CRTP) so
+// the shared path costs nothing over a hand written driver.
+//
+// A backend must provide, accessible to SFE_AccelCore<Backend>:
+//
+//   bool readAccelRegisters(rawOutputData *rawAccelData); // read and decode the output registers
+//   bool readRangeSetting(int *range);                    // read the range code from the part
+//   float getConversion(int range);                       // g per count for a range code, 0 if unknown
+//   bool readFifoLevel(uint16_t *frames);                 // number of complete frames in the FIFO
+//   uint8_t fifoDataRegister();                           // FIFO read port
+//   uint8_t fifoFrameBytes();                             // bytes per XYZ frame
+//   void decodeFifoFrame(const uint8_t *frame, rawOutputData *sample);
+//   bool isConfigRegister(uint8_t reg);                   // false for command registers (reset, buffer clear)
+//   bool isDestructiveRead(uint8_t reg);                  // reading pops data (FIFO port)
+//   uint8_t sentinelRegister();                           // configured register that reads back as written
+//
+// Each register transaction holds the bus lock set with setBusLock(), if any,
+// so several tasks may share the bus. The cached range, the counters, the
+// offsets and the last sample (getLastRaw()) are only touched under the same
+// lock. Read-modify-write
+// configuration calls are single transactions each and should be made from
+// one task.
+//
+// Failed transactions are retried within a retry budget and a deadline per
+// operation (setRecovery()). A register whose read pops data is only retried
+// when the address was not acknowledged: after a short read its bytes are
+// gone, so a repeat would return later frames. Before the second retry the bus is unlocked by
+// clocking SCL by hand if the pins are known (setRecoveryPins()). Successful
+// writes to configuration registers are shadowed; after a failure the sentinel
+// register is read back and, if the part has lost it (brown-out or reset),
+// the shadow is written out again.
+
+#pragma once
+
+#include <Wire.h>
+#include "SFE_AccelLock.h"
+
+// Largest single I2C read. Follows the core's Wire buffer where Wire.h
+// publishes it (ESP32 I2C_BUFFER_LENGTH, AVR and most others BUFFER_LENGTH);
+// raising it above the real buffer only produces short reads.
+#ifndef SFE_ACCEL_I2C_BUFFER_LENGTH
+#if defined(I2C_BUFFER_LENGTH) && I2C_BUFFER_LENGTH < 256
+#define SFE_ACCEL_I2C_BUFFER_LENGTH I2C_BUFFER_LENGTH
+#elif defined(BUFFER_LENGTH) && BUFFER_LENGTH < 256
+#define SFE_ACCEL_I2C_BUFFER_LENGTH BUFFER_LENGTH
+#else
+#define SFE_ACCEL_I2C_BUFFER_LENGTH 32
+#endif
+#endif
+
+// Configuration registers remembered for re-applying after a brown-out
+#ifndef SFE_ACCEL_SHADOW_SIZE
+#define SFE_ACCEL_SHADOW_SIZE 16
+#endif
+
+#define SENSORS_GRAVITY_EARTH (9.80665F)
+
+struct outputData
+{
+  float xData;
+  float yData;
+  float zData;
+};
+
+struct rawOutputData
+{
+  int16_t xData;
+  int16_t yData;
+  int16_t zData;
+};
+
+// Bus and sample counters, cheap enough to leave enabled
+struct accelCounters
+{
+  uint32_t reads;     // register read transactions
+  uint32_t writes;    // register write transactions
+  uint32_t bytesRead;
+  uint32_t busErrors; // NACKs and short reads
+  uint32_t samples;   // samples read from the output registers or the FIFO
+  uint32_t retries;   // transactions repeated after an error
+  uint32_t busResets; // SCL clock-out bus unlocks
+  uint32_t reinits;   // configuration re-applied after the part lost it
+  uint32_t fifoLost;  // FIFO frames cut off by a short read, possibly already popped
+};
+
+struct accelShadowEntry
+{
+  uint8_t reg;
+  uint8_t value;
+};
+
+template <class Backend>
+class SFE_AccelCore
+{
+public:
+  SFE_AccelCore(uint8_t address) : _address(address) {}
+
+  void setBusLock(SFE_AccelBusLock *lock);
+  void setRecovery(uint8_t retries, uint16_t deadlineMs);
+  void setRecoveryPins(int sdaPin, int sclPin, uint32_t clockHz = 0);
+  bool unlockBus();
+  bool checkConfiguration();
+
+  bool writeRegisterByte(uint8_t registerAddress, uint8_t data);
+  bool readRegisterRegion(uint8_t registerAddress, uint8_t* sensorData, int len);
+
+  bool getAccelData(outputData *userData);
+  bool convAccelData(outputData *userAccel, rawOutputData *rawAccelData);
+  bool convAccelData(outputData *userAccel, const rawOutputData *rawAccelData, int range);
+  bool getRawAccelRegisterData(rawOutputData *rawAccelData);
+  bool getFifoLevel(uint16_t *frames);
+  int getFifoData(rawOutputData *samples, int maxSamples);
+  int readFifoFrames(rawOutputData *samples, int count);
+
+  bool calibrateOffsets();
+  void offsetValues(float &x, float &y, float &z);
+  void setOffset(float x, float y, float z);
+  void getOffset(float &x, float &y, float &z);
+  void getLastRaw(rawOutputData *raw);
+
+  void getCounters(accelCounters *counters);
+  void resetCounters();
+
+protected:
+  Backend &backend() { return *static_cast<Backend *>(this); }
+
+  void setPort(TwoWire &wirePort);
+  void applyTimeout();
+  bool clockOutBus();
+
+  int readRegion(uint8_t registerAddress, uint8_t *sensorData, int len);
+  int transferRead(uint8_t registerAddress, uint8_t *sensorData, int len);
+  bool transferWrite(uint8_t registerAddress, uint8_t data);
+  bool retryAllowed(uint8_t attempt, unsigned long start);
+  bool verifyConfiguration();
+  void shadowWrite(uint8_t registerAddress, uint8_t data);
+  void clearShadow() { _shadowCount = 0; } // after a deliberate reset
+  int cachedRange();
+  void cacheRange(int range);
+
+  // Shared with other tasks, only touched under the bus lock
+  rawOutputData rawAccelData = {0, 0, 0}; // last sample from getAccelData()
+  float xOffset = 0.0;
+  float yOffset = 0.0;
+  float zOffset = 0.0;
+
+  int _range = -1; // Keep a local copy of the range. Default to "unknown" (-1).
+  uint8_t _address;
+  TwoWire *_i2cPort = &Wire;
+  SFE_AccelBusLock *_busLock = nullptr;
+  accelCounters _counters = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+  uint8_t _retries = 2;
+  uint16_t _deadlineMs = 20;
+  int _sdaPin = -1;
+  int _sclPin = -1;
+  uint32_t _clockHz = 0;
+  bool _checkPending = false; // verify the configuration after the next success
+
+  accelShadowEntry _shadow[SFE_ACCEL_SHADOW_SIZE];
+  uint8_t _shadowCount = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////////
+// setBusLock()
+//
+// Sets the lock held around every register transaction. Drivers that
+// share an I2C bus must share the lock. nullptr (the default) disables
+// locking.
+//
+template <class Backend>
+void SFE_AccelCore<Backend>::setBusLock(SFE_AccelBusLock *lock)
+{
+  _busLock = lock;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// setRecovery()
+//
+// Sets how hard a failed transaction is retried.
+//
+// Parameter:
+// retries - extra attempts after the first, 0 to fail at once
+// deadlineMs - no retry is started once the operation is this old, 0 for
+//              no limit. Where the core supports it (WIRE_HAS_TIMEOUT) it
+//              also bounds a single transfer, so a stuck bus cannot hang it;
+//              begin() applies the default of 20 ms.
+//
+template <class Backend>
+void SFE_AccelCore<Backend>::setRecovery(uint8_t retries, uint16_t deadlineMs)
+{
+  _retries = retries;
+  _deadlineMs = deadlineMs;
+
+  applyTimeout();
+}
+
+// selects the bus; called from the backend's begin()
+template <class Backend>
+void SFE_AccelCore<Backend>::setPort(TwoWire &wirePort)
+{
+  _i2cPort = &wirePort;
+
+  applyTimeout();
+}
+
+// hands the deadline to Wire so a held line cannot block a single transfer
+template <class Backend>
+void SFE_AccelCore<Backend>::applyTimeout()
+{
+#if defined(WIRE_HAS_TIMEOUT)
+  _i2cPort->setWireTimeout(_deadlineMs * 1000UL, true);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// setRecoveryPins()
+//
+// Gives unlockBus() the pins of the bus. Without them a held SDA line
+// can only be cleared by power cycling.
+//
+// Parameter:
+// sdaPin, sclPin - Arduino pin numbers of the bus
+// clockHz - bus clock to restore after the unlock, 0 for the core default
+//
+template <class Backend>
+void SFE_AccelCore<Backend>::setRecoveryPins(int sdaPin, int sclPin, uint32_t clockHz)
+{
+  _sdaPin = sdaPin;
+  _sclPin = sclPin;
+  _clockHz = clockHz;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// unlockBus()
+//
+// Frees a bus whose SDA is held low by a slave stuck mid-byte: clocks SCL
+// by hand until the slave lets go (at most 9 clocks), sends a STOP and
+// restarts Wire. Both lines are driven open-drain.
+//
+// Returns true if SDA is high afterwards.
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::unlockBus()
+{
+  SFE_AccelBusGuard guard(_busLock);
+
+  return clockOutBus();
+}
+
+// unlockBus() for callers already holding the bus lock
+template <class Backend>
+bool SFE_AccelCore<Backend>::clockOutBus()
+{
+  if (_sdaPin < 0 || _sclPin < 0)
+    return false;
+
+  _counters.busResets++;
+
+  _i2cPort->end();
+
+  pinMode(_sdaPin, INPUT_PULLUP);
+  pinMode(_sclPin, INPUT_PULLUP);
+  delayMicroseconds(5);
+
+  for (uint8_t i = 0; i < 9 && digitalRead(_sdaPin) == LOW; i++)
+  {
+    digitalWrite(_sclPin, LOW);
+    pinMode(_sclPin, OUTPUT);
+    delayMicroseconds(5);
+    pinMode(_sclPin, INPUT_PULLUP);
+    delayMicroseconds(5);
+  }
+
+  // STOP: SDA rises while SCL is high
+  digitalWrite(_sclPin, LOW);
+  pinMode(_sclPin, OUTPUT);
+  digitalWrite(_sdaPin, LOW);
+  pinMode(_sdaPin, OUTPUT);
+  delayMicroseconds(5);
+  pinMode(_sclPin, INPUT_PULLUP);
+  delayMicroseconds(5);
+  pinMode(_sdaPin, INPUT_PULLUP);
+  delayMicroseconds(5);
+
+  bool released = digitalRead(_sdaPin) == HIGH;
+
+  _i2cPort->begin();
+  if (_clockHz > 0)
+    _i2cPort->setClock(_clockHz);
+
+  applyTimeout();
+
+  return released;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// checkConfiguration()
+//
+// Reads the sentinel register back and re-applies the shadowed
+// configuration if the part has lost it. Done automatically after a bus
+// error; call it periodically to also catch a silent brown-out.
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::checkConfiguration()
+{
+  SFE_AccelBusGuard guard(_busLock);
+
+  return verifyConfiguration();
+}
+
+template <class Backend>
+bool SFE_AccelCore<Backend>::verifyConfiguration()
+{
+  _checkPending = false;
+
+  uint8_t sentinel = backend().sentinelRegister();
+  int8_t entry = -1;
+
+  for (uint8_t i = 0; i < _shadowCount; i++)
+  {
+    if (_shadow[i].reg == sentinel)
+      entry = i;
+  }
+
+  if (entry < 0)
+    return true; // nothing configured yet
+
+  uint8_t value;
+  if (transferRead(sentinel, &value, 1) != 1)
+  {
+    _checkPending = true;
+    return false;
+  }
+
+  if (value == _shadow[entry].value)
+    return true;
+
+  // The part has reset; write the configuration back in the original order
+  _counters.reinits++;
+  _range = -1;
+
+  for (uint8_t i = 0; i < _shadowCount; i++)
+  {
+    if (!transferWrite(_shadow[i].reg, _shadow[i].value))
+    {
+      _checkPending = true;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// shadowWrite()
+//
+// Remembers a configuration write. A register written again moves to the
+// end so replaying keeps the order of the last writes, e.g. a part that
+// must be in stand-by while configured is re-enabled last.
+//
+template <class Backend>
+void SFE_AccelCore<Backend>::shadowWrite(uint8_t registerAddress, uint8_t data)
+{
+  if (!backend().isConfigRegister(registerAddress))
+    return;
+
+  uint8_t i = 0;
+  while (i < _shadowCount && _shadow[i].reg != registerAddress)
+    i++;
+
+  if (i == _shadowCount)
+  {
+    if (_shadowCount == SFE_ACCEL_SHADOW_SIZE)
+      return; // full, the register will not be restored
+    _shadowCount++;
+  }
+
+  for (; i + 1 < _shadowCount; i++)
+    _shadow[i] = _shadow[i + 1];
+
+  _shadow[_shadowCount - 1].reg = registerAddress;
+  _shadow[_shadowCount - 1].value = data;
+}
+
+// true if another attempt fits the budget; unlocks the bus before the second retry
+template <class Backend>
+bool SFE_AccelCore<Backend>::retryAllowed(uint8_t attempt, unsigned long start)
+{
+  _checkPending = true;
+
+  if (attempt >= _retries)
+    return false;
+
+  if (_deadlineMs > 0 && millis() - start >= _deadlineMs)
+    return false;
+
+  _counters.retries++;
+
+  if (attempt > 0)
+    clockOutBus();
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// readRegisterRegion()
+//
+// Reads len consecutive bytes starting at registerAddress. len must fit in
+// the Wire buffer; use getFifoData() for longer bursts.
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::readRegisterRegion(uint8_t registerAddress, uint8_t* sensorData, int len)
+{
+  return readRegion(registerAddress, sensorData, len) == len;
+}
+
+// Reads with retries. Returns len, the bytes received before a short read of
+// a register that pops data (not retried), or -1 on failure.
+template <class Backend>
+int SFE_AccelCore<Backend>::readRegion(uint8_t registerAddress, uint8_t* sensorData, int len)
+{
+  SFE_AccelBusGuard guard(_busLock);
+
+  unsigned long start = millis();
+  int received;
+
+  for (uint8_t attempt = 0; (received = transferRead(registerAddress, sensorData, len)) != len; attempt++)
+  {
+    if (received >= 0 && backend().isDestructiveRead(registerAddress))
+    {
+      _checkPending = true;
+      return received;
+    }
+
+    if (!retryAllowed(attempt, start))
+      return -1;
+  }
+
+  // The read itself succeeded; a failed check stays pending for the next operation
+  if (_checkPending)
+    verifyConfiguration();
+
+  return len;
+}
+
+// one read attempt; returns the bytes received, -1 if the address was not acknowledged
+template <class Backend>
+int SFE_AccelCore<Backend>::transferRead(uint8_t registerAddress, uint8_t* sensorData, int len)
+{
+  _counters.reads++;
+
+  _i2cPort->beginTransmission(_address);
+  _i2cPort->write(registerAddress); // Register address to read from
+  uint8_t err = _i2cPort->endTransmission(); // Send the request without stopping the transmission
+
+  if (err > 0) {
+    _counters.busErrors++;
+    return -1;
+  }
+
+  uint8_t bytesAvailable = _i2cPort->requestFrom(static_cast<int>(_address), static_cast<int>(len), static_cast<int>(true)); // Request len byte of data
+
+  int received = bytesAvailable < len ? bytesAvailable : len;
+
+  for (int i = 0; i < received; i++) {
+    sensorData[i] = _i2cPort->read(); // Read the bytes from the sensor and store them in the array pointed to by sensorData
+  }
+  _counters.bytesRead += received;
+
+  if (received < len)
+    _counters.busErrors++;
+
+  return received;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// writeRegisterByte()
+
+template <class Backend>
+bool SFE_AccelCore<Backend>::writeRegisterByte(uint8_t registerAddress, uint8_t data)
+{
+  SFE_AccelBusGuard guard(_busLock);
+
+  unsigned long start = millis();
+
+  for (uint8_t attempt = 0; !transferWrite(registerAddress, data); attempt++)
+  {
+    if (!retryAllowed(attempt, start))
+      return false;
+  }
+
+  // Shadow first so a replay does not undo this write
+  shadowWrite(registerAddress, data);
+
+  // The write has landed; a failed check stays pending for the next operation
+  if (_checkPending)
+    verifyConfiguration();
+
+  return true;
+}
+
+// one write attempt
+template <class Backend>
+bool SFE_AccelCore<Backend>::transferWrite(uint8_t registerAddress, uint8_t data)
+{
+  _counters.writes++;
+
+  _i2cPort->beginTransmission(_address);
+  _i2cPort->write(registerAddress); // Register address to write to
+  _i2cPort->write(data); // Data to write
+  uint8_t err = _i2cPort->endTransmission(); // End the transmission
+
+  if (err > 0) {
+    _counters.busErrors++;
+    return false; // Return false if there's a communication error
+  }
+
+  return true; // Return true if the write operation was successful
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// getRawAccelRegisterData()
+//
+// Retrieves the raw register values representing accelerometer data.
+//
+// Parameter:
+// *rawAccelData - a pointer to the data struct that holds acceleromter X/Y/Z data.
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::getRawAccelRegisterData(rawOutputData *rawAccelData)
+{
+  if (!backend().readAccelRegisters(rawAccelData))
+    return false;
+
+  SFE_AccelBusGuard guard(_busLock);
+  _counters.samples++;
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// getAccelData()
+//
+// Retrieves the raw accelerometer data and calls a conversion function to convert the raw values.
+//
+// Parameter:
+// *userData - a pointer to the user's data struct that will hold acceleromter data.
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::getAccelData(outputData *userData)
+{
+  rawOutputData raw; // local so concurrent callers do not share a buffer
+
+  {
+    SFE_AccelBusGuard guard(_busLock);
+    raw = rawAccelData; // axes without new data keep their last value
+  }
+
+  if(!getRawAccelRegisterData(&raw))
+    return false;
+
+  if(!convAccelData(userData, &raw))
+    return false;
+
+  SFE_AccelBusGuard guard(_busLock);
+  rawAccelData = raw;
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// convAccelData()
+//
+// Converts raw acceleromter data with the current accelerometer's range settings.
+//
+// Parameter:
+// *userData - a pointer to the user's data struct that will hold acceleromter data.
+// *rawAccelData - a pointer to the data struct that holds acceleromter X/Y/Z data.
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::convAccelData(outputData *userAccel, rawOutputData *rawAccelData)
+{
+  int range = cachedRange();
+
+  if (range < 0) // If the G-range is unknown, read it
+  {
+    if(!backend().readRangeSetting(&range))
+      return false;
+
+    cacheRange(range);
+  }
+
+  return convAccelData(userAccel, rawAccelData, range);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// convAccelData()
+//
+// Converts raw acceleromter data captured at a given range, e.g. samples
+// tagged by the auto-ranger that predate the current range setting.
+//
+// Parameter:
+// *userData - a pointer to the user's data struct that will hold acceleromter data.
+// *rawAccelData - a pointer to the data struct that holds acceleromter X/Y/Z data.
+// range - the range code the data was captured with
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::convAccelData(outputData *userAccel, const rawOutputData *rawAccelData, int range)
+{
+  float conv = backend().getConversion(range);
+  if (conv == 0)
+    return false;
+
+  userAccel->xData = (float)rawAccelData->xData * conv;
+  userAccel->yData = (float)rawAccelData->yData * conv;
+  userAccel->zData = (float)rawAccelData->zData * conv;
+
+  return true;
+}
+
+// number of complete frames waiting in the FIFO
+template <class Backend>
+bool SFE_AccelCore<Backend>::getFifoLevel(uint16_t *frames)
+{
+  return backend().readFifoLevel(frames);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// getFifoData()
+//
+// Drains up to maxSamples frames from the FIFO. The level is read once and
+// the frames are then fetched in as few bursts as the Wire buffer allows.
+//
+// Parameter:
+// *samples - array that receives the raw samples, oldest first
+// maxSamples - size of the array
+//
+// Returns the number of samples read, or -1 on a bus error.
+//
+template <class Backend>
+int SFE_AccelCore<Backend>::getFifoData(rawOutputData *samples, int maxSamples)
+{
+  uint16_t frames;
+
+  if (!getFifoLevel(&frames))
+    return -1;
+
+  int count = (int)frames < maxSamples ? (int)frames : maxSamples;
+
+  return readFifoFrames(samples, count);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// readFifoFrames()
+//
+// Reads exactly count frames from the FIFO without checking the level
+// first, e.g. after a watermark interrupt has said they are there. With a
+// Wire buffer of at least count frames this is a single bus transaction.
+//
+// Parameter:
+// *samples - array that receives the raw samples, oldest first
+// count - number of frames to read
+//
+// Returns count. A short read of the FIFO port is not retried, since the
+// bytes it popped cannot be read again; the drain stops there, the cut off
+// frames are counted in fifoLost and the frames received so far are
+// returned. Returns -1 if none were.
+//
+template <class Backend>
+int SFE_AccelCore<Backend>::readFifoFrames(rawOutputData *samples, int count)
+{
+  uint8_t frameBytes = backend().fifoFrameBytes();
+  int framesPerBurst = SFE_ACCEL_I2C_BUFFER_LENGTH / frameBytes;
+  uint8_t buffer[SFE_ACCEL_I2C_BUFFER_LENGTH];
+
+  for (int done = 0; done < count; )
+  {
+    int burst = count - done < framesPerBurst ? count - done : framesPerBurst;
+
+    int received = readRegion(backend().fifoDataRegister(), buffer, burst * frameBytes);
+    int frames = received > 0 ? received / frameBytes : 0;
+
+    for (int i = 0; i < frames; i++)
+      backend().decodeFifoFrame(&buffer[i * frameBytes], &samples[done + i]);
+
+    done += frames;
+
+    if (frames < burst)
+    {
+      SFE_AccelBusGuard guard(_busLock);
+      _counters.samples += done;
+      if (received >= 0)
+        _counters.fifoLost += burst - frames;
+
+      return done > 0 ? done : -1;
+    }
+  }
+
+  SFE_AccelBusGuard guard(_busLock);
+  _counters.samples += count;
+
+  return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// calibrateOffsets()
+//
+// Averages 100 samples into the offsets. Samples lost to bus errors that
+// survived the retries are skipped; it only gives up if more than 10 fail.
+//
+template <class Backend>
+bool SFE_AccelCore<Backend>::calibrateOffsets()
+{
+    outputData data;
+    int numSamples = 100;
+    int maxFailures = 10;
+    int good = 0, failed = 0;
+    float xSum = 0.0, ySum = 0.0, zSum = 0.0;
+
+
+    // Take multiple samples to average out noise
+    while (good < numSamples)
+    {
+        if (!getAccelData(&data))
+        {
+            if (++failed > maxFailures)
+                return false;
+            continue;
+        }
+
+        xSum += data.xData;
+        ySum += data.yData;
+        zSum += data.zData - 1;
+        good++;
+        delay(10);
+    }
+
+    // Calculate average
+    setOffset(xSum / numSamples, ySum / numSamples, zSum / numSamples); // Assuming z-axis aligned with gravity
+
+    return true;
+}
+
+template <class Backend>
+void SFE_AccelCore<Backend>::setOffset(float x, float y, float z){
+  SFE_AccelBusGuard guard(_busLock);
+  xOffset = x;
+  yOffset = y;
+  zOffset = z;
+}
+
+template <class Backend>
+void SFE_AccelCore<Backend>::getOffset(float &x, float &y, float &z){
+  SFE_AccelBusGuard guard(_busLock);
+  x = xOffset;
+  y = yOffset;
+  z = zOffset;
+}
+
+template <class Backend>
+void SFE_AccelCore<Backend>::offsetValues(float &x, float &y, float &z) {
+  SFE_AccelBusGuard guard(_busLock);
+  x = x - xOffset;
+  y = y - yOffset;
+  z = z - zOffset;
+}
+
+// copy of the last sample read by getAccelData()
+template <class Backend>
+void SFE_AccelCore<Backend>::getLastRaw(rawOutputData *raw)
+{
+  SFE_AccelBusGuard guard(_busLock);
+  *raw = rawAccelData;
+}
+
+// copy of the bus and sample counters
+template <class Backend>
+void SFE_AccelCore<Backend>::getCounters(accelCounters *counters)
+{
+  SFE_AccelBusGuard guard(_busLock);
+  *counters = _counters;
+}
+
+template <class Backend>
+void SFE_AccelCore<Backend>::resetCounters()
+{
+  SFE_AccelBusGuard guard(_busLock);
+  _counters = accelCounters{0, 0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+// range code last written or read, -1 if unknown
+template <class Backend>
+int SFE_AccelCore<Backend>::cachedRange()
+{
+  SFE_AccelBusGuard guard(_busLock);
+  return _range;
+}
+
+template <class Backend>
+void SFE_AccelCore<Backend>::cacheRange(int range)
+{
+  SFE_AccelBusGuard guard(_busLock);
+  _range = range;
+}
@@ -0,0 +1,83 @@
+// Bus lock used by SFE_AccelCore around every register transaction. The
+// default is no lock, which is what a single-threaded sketch wants. When
+// several tasks share a sensor or the I2C bus, give every driver on that bus
+// the same lock object with setBusLock().
+//
+// SFE_AccelMutexLock is provided for FreeRTOS builds (ESP32, or any core that
+// defines SFE_ACCEL_FREERTOS) and for host builds that define
+// SFE_ACCEL_HOST_THREADS, where it wraps std::mutex so the drivers can be run
+// from std::thread against the mock bus in extras/host_test. Anything else
+// can derive from SFE_AccelBusLock.
+
+#pragma once
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(SFE_ACCEL_FREERTOS)
+#define SFE_ACCEL_FREERTOS
+#endif
+
+#if defined(SFE_ACCEL_HOST_THREADS)
+#include <mutex>
+#elif defined(SFE_ACCEL_FREERTOS)
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <FreeRTOS.h>
+#include <semphr.h>
+#endif
+#endif
+
+class SFE_AccelBusLock
+{
+public:
+  virtual void lock() = 0;
+  virtual void unlock() = 0;
+};
+
+#if defined(SFE_ACCEL_HOST_THREADS)
+
+class SFE_AccelMutexLock : public SFE_AccelBusLock
+{
+public:
+  void lock() { _mutex.lock(); }
+  void unlock() { _mutex.unlock(); }
+
+protected:
+  std::mutex _mutex;
+};
+
+#elif defined(SFE_ACCEL_FREERTOS)
+
+class SFE_AccelMutexLock : public SFE_AccelBusLock
+{
+public:
+  SFE_AccelMutexLock() { _mutex = xSemaphoreCreateMutexStatic(&_storage); }
+  void lock() { xSemaphoreTake(_mutex, portMAX_DELAY); }
+  void unlock() { xSemaphoreGive(_mutex); }
+
+protected:
+  StaticSemaphore_t _storage; // no heap, safe as a global
+  SemaphoreHandle_t _mutex;
+};
+
+#endif
+
+// Holds the lock for the life of a scope; a null lock is a no-op
+class SFE_AccelBusGuard
+{
+public:
+  SFE_AccelBusGuard(SFE_AccelBusLock *lock) : _lock(lock)
+  {
+    if (_lock != nullptr)
+      _lock->lock();
+  }
+
+  ~SFE_AccelBusGuard()
+  {
+    if (_lock != nullptr)
+      _lock->unlock();
+  }
+
+private:
+  SFE_AccelBusLock *_lock;
+};